@@ -2,6 +2,7 @@
 #include "ConfigManager.h"
 #include "DebugLogger.h"
 #include "PdfParser.h"
+#include "PerfStats.h"
 #include "SystemUtils.h"
 #include "UIUtils.h"
 #include "nlohmann/json.hpp"
@@ -15,13 +16,35 @@ using json = nlohmann::json;
 AppController::AppController() : screen_(ScreenInteractive::Fullscreen()) {}
 
 AppController::~AppController() {
-    if (app_state_.load_thread.joinable()) {
-        app_state_.load_thread.join();
+    PerfStats::RemoveFlushTimer();
+    if (db_manager_) {
+        db_manager_->SetWritesAppliedCallback(nullptr);
     }
+    // The indexer writes through db_manager_, which is destroyed before app_state_.
+    if (app_state_.text_indexer) {
+        app_state_.text_indexer->Stop();
+    }
+    // An import waits for its files in flight, so it has to go while the executor runs them.
+    app_state_.importer.reset();
+    app_state_.load_token.Cancel();
+    // The open book's tasks stop at their next check when it goes; left running, a search
+    // index build would hold up the shutdown below until the whole book was indexed.
+    app_state_.book_view_model.reset();
+    // Running tasks finish and queued ones are dropped while everything they touch is alive.
+    if (executor_) {
+        executor_->Shutdown();
+    }
+    // A finished load may still be queued; apply it so its model is torn down here too.
+    app_state_.ApplyPublishedUpdates();
+    app_state_.book_view_model.reset();
     
-    stop_refresh_thread_ = true;
-    if (refresh_thread_.joinable()) {
-        refresh_thread_.join();
+    {
+        std::lock_guard<std::mutex> lock(clock_mutex_);
+        stop_clock_ = true;
+    }
+    clock_cv_.notify_all();
+    if (clock_thread_.joinable()) {
+        clock_thread_.join();
     }
 }
 
@@ -35,7 +58,7 @@ int AppController::Run(int argc, char* argv[]) {
         if (argc > 1) {
             std::string path_from_args = argv[1];
             if (fs::exists(path_from_args)) {
-                app_state_.message_to_show = library_manager_->AddBook(path_from_args, *db_manager_, screen_.dimx(), screen_.dimy());
+                app_state_.message_to_show = library_manager_->AddBook(path_from_args, *db_manager_, *executor_, screen_.dimx(), screen_.dimy());
                 app_state_.current_view = View::ShowMessage;
             } else {
                 app_state_.message_to_show = "Error: File provided via command-line does not exist.";
@@ -44,10 +67,11 @@ int AppController::Run(int argc, char* argv[]) {
         }
         
         RefreshBooks();
+        app_state_.text_indexer->Start();
         
         // Start background sync on launch
         if (app_state_.cloud_sync_enabled) {
-            std::thread([this] {
+            executor_->Submit(TaskPriority::Background, [this] {
                 sync_controller_->full_sync([this](bool success, std::string msg) {
                     if (success) {
                         DebugLogger::log("Startup sync completed successfully.");
@@ -56,11 +80,25 @@ int AppController::Run(int argc, char* argv[]) {
                         DebugLogger::log("Startup sync failed: " + msg);
                     }
                 });
-            }).detach();
+            });
         }
         
         // Create main renderer with UI components
         auto main_renderer = Renderer(ui_components_->GetMainContainer(), [&] {
+            uint64_t version = app_state_.changes.BeginFrame();
+            // Worker updates, finished layouts and page turns queued by key repeats land here,
+            // once per frame, so building the document below only reads the state.
+            // Anything published after BeginFrame() has its own wake-up pending.
+            bool applied = app_state_.ApplyPublishedUpdates();
+            applied = event_handlers_->SyncReaderLayout() || applied;
+            applied = event_handlers_->ApplyPendingNavigation() || applied;
+            // Reuse the last frame when no state has changed since it was built.
+            if (!applied && last_document_ && version == last_document_version_ &&
+                screen_.dimx() == last_document_width_ && screen_.dimy() == last_document_height_) {
+                return last_document_;
+            }
+
+            ScopedPerfTimer build_timer(PerfStage::Build);
             Element document;
             switch (app_state_.current_view) {
                 case View::Library:
@@ -90,29 +128,46 @@ int AppController::Run(int argc, char* argv[]) {
                 case View::SystemInfo:
                     document = ui_components_->RenderSystemInfoView();
                     break;
+                case View::GlobalSearch:
+                    document = ui_components_->RenderGlobalSearchView();
+                    break;
+                case View::Import:
+                    document = ui_components_->RenderImportView();
+                    break;
                 default:
                     document = text("Unknown view state") | center;
             }
+            if (app_state_.perf_overlay_enabled) {
+                document = dbox({document, hbox({filler(), vbox({ui_components_->RenderPerfOverlay(), filler()})})});
+            }
+            document = ui_components_->TimeFrame(document);
+            last_document_ = document;
+            last_document_version_ = version;
+            last_document_width_ = screen_.dimx();
+            last_document_height_ = screen_.dimy();
             return document;
         });
         
         // Create event handler
         auto refresh_books_func = [this]() { RefreshBooks(); };
         auto event_handler = CatchEvent(main_renderer, [&](Event event) -> bool {
+            // Input may change anything on screen; Event::Custom only carries wake-ups.
+            // Handlers must see what workers published before this event, e.g. a loaded book.
+            if (app_state_.ApplyPublishedUpdates() || event != Event::Custom) {
+                app_state_.changes.Touch();
+            }
+            ScopedPerfTimer event_timer(PerfStage::Event);
             return event_handlers_->HandleEvent(event, ui_components_->GetMainContainer(), refresh_books_func);
         });
         
-        // Start refresh thread
-        refresh_thread_ = std::thread([&] {
-            while (!stop_refresh_thread_) {
-                using namespace std::chrono_literals;
-                std::this_thread::sleep_for(1s);
-                screen_.Post(Event::Custom);
-            }
-        });
+        // Redraws are driven by state changes instead of a periodic tick
+        app_state_.changes.SetWakeCallback([this] { screen_.Post(Event::Custom); });
+        clock_thread_ = std::thread(&AppController::ClockLoop, this);
+        PerfStats::InstallFlushTimer();
         
         // Main loop
         while(app_state_.current_view != View::Exiting) {
+            app_state_.changes.MarkDirty(); // The console may have drawn over the screen
             screen_.Loop(event_handler);
             
             if (app_state_.current_view == View::FirstTimeSetup || 
@@ -218,21 +273,35 @@ void AppController::InitializeManagersFromConfig(const fs::path& data_path) {
     fs::create_directories(config_dir); // Ensure it exists
     DebugLogger::init((config_dir / "debug.log").string());
     
+    // Shared worker pool for sync, downloads, deletes and book loads
+    executor_ = std::make_unique<TaskExecutor>();
+
     // Initialize Database and Config Managers
     fs::path db_path = config_dir / "library.db";
     db_manager_ = std::make_unique<DatabaseManager>(db_path.string());
-    db_manager_->InitDatabase();
+    if (!db_manager_->InitDatabase()) {
+        throw std::runtime_error("Could not open or upgrade the library database " + db_path.string() + "; see " +
+                                 (config_dir / "debug.log").string() + ".");
+    }
     db_manager_->InitializeSystemSettings(data_path.string());
+    // Queued progress and sync-status writes change the library's order and filters once
+    // they land; RefreshBooks reads the model, so it has to start on the UI thread.
+    db_manager_->SetWritesAppliedCallback([this] {
+        app_state_.Publish([this](AppState&) { RefreshBooks(); });
+    });
+    app_state_.library_model = std::make_unique<LibraryModel>(*db_manager_);
+    app_state_.text_indexer = std::make_unique<TextIndexer>(*db_manager_, [this] { app_state_.changes.MarkDirty(); });
 
     config_manager_ = std::make_unique<ConfigManager>(*db_manager_);
     config_manager_->LoadSettings();
+    app_state_.library_model->SetSortKey(config_manager_->GetLibrarySortKey());
     DebugLogger::log("Config loaded. Library path from config: " + config_manager_->Get("library_path"));
     
     // Initialize all other managers using the ConfigManager
     library_manager_ = std::make_unique<LibraryManager>(*config_manager_);
     auth_manager_ = std::make_unique<GoogleAuthManager>(*config_manager_);
     drive_manager_ = std::make_unique<GoogleDriveManager>(*auth_manager_);
-    sync_controller_ = std::make_unique<SyncController>(*db_manager_, *drive_manager_, *config_manager_);
+    sync_controller_ = std::make_unique<SyncController>(*db_manager_, *drive_manager_, *config_manager_, *executor_);
     
     // The initial sync state is determined by the presence of a refresh token.
     // The user can then disable it at runtime.
@@ -245,7 +314,7 @@ void AppController::InitializeUI() {
     
     event_handlers_ = std::make_unique<EventHandlers>(
         app_state_, screen_, ui_state_mutex_, *db_manager_, 
-        *library_manager_, *sync_controller_, *auth_manager_, *config_manager_
+        *library_manager_, *sync_controller_, *auth_manager_, *config_manager_, *executor_
     );
     
     // Set UI components reference for event handlers
@@ -259,34 +328,42 @@ void AppController::LoadInitialData() {
     UpdatePickerEntries(app_state_.current_picker_path, app_state_.picker_entries, app_state_.selected_picker_entry);
 }
 
-void AppController::RefreshBooks() {
-    std::lock_guard<std::mutex> lock(ui_state_mutex_);
-    app_state_.books = db_manager_->GetAllBooks();
-    app_state_.book_display_list.clear();
-    
-    for (const auto& book : app_state_.books) {
-        std::string display_item = book.title + " - " + book.author;
-
-        if (!book.format.empty()) {
-            display_item += " [" + book.format + "]";
+void AppController::ClockLoop() {
+    std::unique_lock<std::mutex> lock(clock_mutex_);
+    auto last_minute = std::chrono::time_point_cast<std::chrono::minutes>(std::chrono::system_clock::now());
+    while (!stop_clock_) {
+        // Waking is cheap; only redraw when the clock's minute or the perf overlay changes.
+        // The view is not checked here: it belongs to the UI thread, and one frame a minute
+        // in the other views costs nothing.
+        auto now = std::chrono::system_clock::now();
+        auto next_second = std::chrono::time_point_cast<std::chrono::seconds>(now) + std::chrono::seconds(1);
+        if (clock_cv_.wait_until(lock, next_second, [this] { return stop_clock_; })) {
+            return;
         }
-
-        int progress = 0;
-        if (book.total_pages > 0) {
-            progress = static_cast<int>((static_cast<float>(book.current_page) / book.total_pages) * 100);
-        }
-        display_item += " [" + std::to_string(progress) + "%]";
-
-        if (app_state_.cloud_sync_enabled) {
-            if (book.sync_status == "local") display_item += " [💻]";
-            else if (book.sync_status == "cloud") display_item += " [☁️]";
-            else if (book.sync_status == "synced") display_item += " [✓]";
+        auto minute = std::chrono::time_point_cast<std::chrono::minutes>(std::chrono::system_clock::now());
+        bool minute_changed = minute != last_minute;
+        last_minute = minute;
+        if (app_state_.perf_overlay_enabled || minute_changed) {
+            app_state_.changes.MarkDirty();
         }
-        app_state_.book_display_list.push_back(display_item);
     }
-    
-    app_state_.last_library_width = 0;
-    app_state_.last_library_height = 0;
+}
+
+void AppController::RefreshBooks() {
+    // The delta is read on a worker, so the UI thread never waits for the connection while
+    // an import batch or a text-index chapter holds it; the model takes it between frames.
+    int64_t since = app_state_.library_model->GetChangeSequence();
+    executor_->Submit(TaskPriority::Io, [this, since] {
+        auto changes = std::make_shared<LibraryChanges>(db_manager_->GetLibraryChangesSince(since));
+        app_state_.Publish([changes](AppState& state) {
+            // Scanning for unindexed books reads the whole table; only do it when the delta says so.
+            if (state.library_model->Update(*changes)) {
+                state.text_indexer->RequestScan();
+            }
+            state.last_library_width = 0;
+            state.last_library_height = 0;
+        });
+    });
 }
 
 void AppController::HandleConsoleInteraction() {
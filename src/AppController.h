@@ -9,8 +9,11 @@
 #include "GoogleDriveManager.h"
 #include "LibraryManager.h"
 #include "SyncController.h"
+#include "TaskExecutor.h"
 #include "UIComponents.h"
 #include "ftxui/component/screen_interactive.hpp"
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -44,6 +47,7 @@ private:
     std::mutex ui_state_mutex_;
     
     // Backend managers
+    std::unique_ptr<TaskExecutor> executor_; // Runs all one-off background work; shut down first
     std::unique_ptr<ConfigManager> config_manager_;
     std::unique_ptr<LibraryManager> library_manager_;
     std::unique_ptr<DatabaseManager> db_manager_;
@@ -56,9 +60,18 @@ private:
     std::unique_ptr<UIComponents> ui_components_;
     std::unique_ptr<EventHandlers> event_handlers_;
     
+    // Last rendered document, reused while nothing has changed
+    Element last_document_;
+    uint64_t last_document_version_ = 0;
+    int last_document_width_ = 0;
+    int last_document_height_ = 0;
+
     // Background threads
-    std::atomic<bool> stop_refresh_thread_ = false;
-    std::thread refresh_thread_;
+    void ClockLoop();
+    std::mutex clock_mutex_;
+    std::condition_variable clock_cv_;
+    bool stop_clock_ = false;
+    std::thread clock_thread_; // Redraws when the library clock ticks over, and every second under the perf overlay
     
     // Modal functions
     std::function<void(std::string, std::string, std::function<void()>)> open_modal_;
@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <memory>
@@ -13,7 +14,13 @@
 
 #include "Book.h"
 #include "BookViewModel.h"
+#include "CancellationToken.h"
 #include "CommonTypes.h"
+#include "LibraryImporter.h"
+#include "LibraryModel.h"
+#include "MpscQueue.h"
+#include "TaskExecutor.h"
+#include "TextIndexer.h"
 #include "ftxui/component/event.hpp"
 
 namespace fs = std::filesystem;
@@ -30,24 +37,80 @@ enum class View {
     ConfirmOcr,
     DeleteConfirm,
     SystemInfo,
+    GlobalSearch,
+    Import,
     // These are not real views, but states to trigger console interaction
     FirstTimeSetup, 
     BlockingAuth,
     Exiting
 };
 
-// Custom events
-extern const Event BOOK_LOAD_SUCCESS;
-extern const Event BOOK_LOAD_FAILURE;
+// Change notification between state mutations and the UI loop. Anything that changes what is
+// on screen calls MarkDirty(); the renderer only rebuilds its document when the version has
+// moved. Wake-ups coalesce, so a burst of mutations from background work posts one frame.
+class ChangeNotifier {
+public:
+    void SetWakeCallback(std::function<void()> wake) { wake_ = std::move(wake); }
+
+    // Safe from any thread.
+    void MarkDirty() {
+        version_++;
+        if (!wake_pending_.exchange(true) && wake_) {
+            wake_();
+        }
+    }
+    // For mutations on the UI thread that are about to be drawn anyway (input events).
+    void Touch() { version_++; }
+
+    // Called by the renderer at the start of each frame; returns the version being drawn.
+    uint64_t BeginFrame() {
+        wake_pending_ = false;
+        return version_;
+    }
+
+private:
+    std::function<void()> wake_;
+    std::atomic<uint64_t> version_{1};
+    std::atomic<bool> wake_pending_{false};
+};
+
+struct AppState;
+
+// A change to AppState prepared on a worker thread and applied on the UI thread.
+using StateUpdate = std::function<void(AppState&)>;
 
 struct AppState {
+    // Redraw notifications
+    ChangeNotifier changes;
+
+    // Worker threads never write fields directly: they publish an update, and the UI
+    // thread applies it between frames, so rendering always sees a consistent state.
+    void Publish(StateUpdate update) {
+        published_updates.Push(std::move(update));
+        changes.MarkDirty();
+    }
+    // UI thread only. Applies everything published so far; returns true if anything was.
+    bool ApplyPublishedUpdates() {
+        bool applied = false;
+        StateUpdate update;
+        while (published_updates.TryPop(update)) {
+            update(*this);
+            applied = true;
+        }
+        return applied;
+    }
+    MpscQueue<StateUpdate> published_updates;
+
+
     // View
     View current_view = View::Library;
 
     // Library Data
-    std::vector<Book> books;
-    std::vector<std::string> book_display_list;
+    std::unique_ptr<LibraryModel> library_model; // Only the visible window is loaded
     std::vector<std::string> library_visible_books;
+    unsigned long library_visible_generation = 0; // Model generation library_visible_books was copied from
+    bool library_search_active = false;
+    std::string library_search_input;
     int selected_book_index = 0;
     int library_current_page = 0;
     int library_total_pages = 1;
@@ -55,23 +118,45 @@ struct AppState {
     int last_library_width = 0;
     int last_library_height = 0;
 
+    // Library-wide full-text search
+    std::unique_ptr<TextIndexer> text_indexer;
+    std::string global_search_input;
+    std::vector<TextSearchHit> global_search_hits;
+    int selected_global_search_hit = 0;
+
+    // Bulk folder import; kept after it finishes so the Import view can show the totals
+    std::unique_ptr<LibraryImporter> importer;
+
+    // Row of the library selection within the whole table
+    int SelectedLibraryRow() const { return library_current_page * library_entries_per_page + selected_book_index; }
+
     // Reader Data
-    std::unique_ptr<BookViewModel> book_view_model = nullptr;
-    std::mutex model_mutex;
-    std::thread load_thread;
+    Book current_book; // The book open in the reader
+    std::unique_ptr<BookViewModel> book_view_model = nullptr; // Replaced on the UI thread only
+    TaskHandle load_task;
+    CancellationToken load_token; // Cancelled to abandon the load running as load_task
+    bool book_load_in_progress = false; // The Loading view is showing a book open that Esc may cancel
     bool paginated = false;
     int current_page = 0;
+    ReadingPosition current_position; // Resize-stable bookmark; current_page is derived from it after re-pagination
     bool dual_page_mode_enabled = false;
+    bool scroll_mode_enabled = false; // Line-by-line scrolling anchored on current_position
+    int pending_page_turns = 0; // Navigation queued since the last frame; applied when it is drawn
+    int pending_scroll_lines = 0;
+    bool goto_prompt_active = false; // Reader's go-to prompt: a page number or "N%"
+    std::string goto_input;
+    bool search_prompt_active = false; // Reader's in-book search prompt
+    std::string search_input;
+    std::string search_query; // Last submitted search; hits are re-read as the index grows
+    std::vector<ReadingPosition> search_hits;
+    int search_hit_index = -1;
     int last_page_width = 0;
     int last_page_height = 0;
 
-    // TOC State
-    std::vector<std::string> toc_entries;
-    std::vector<std::string> toc_visible_entries;
-    int selected_toc_entry = 0;
-    int toc_current_page = 0;
-    int toc_total_pages = 1;
-    int toc_entries_per_page = 1;
+    // TOC State. Rows come from BookViewModel::GetTocEntries(); only the visible window is rendered.
+    int selected_toc_entry = 0; // Index into the whole TOC
+    int toc_scroll_top = 0;
+    int toc_visible_rows = 1;
 
     // File Picker State
     fs::path current_picker_path = fs::current_path();
@@ -104,6 +189,9 @@ struct AppState {
     std::atomic<SyncStatus> sync_status = SyncStatus::IDLE;
     std::string sync_message;
 
+    // Latency overlay, toggled with 'P'; read by the clock thread
+    std::atomic<bool> perf_overlay_enabled{false};
+
     // System Info View Data
     std::vector<std::pair<std::string, std::string>> system_info_data;
 };
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include "CommonTypes.h"
 
 // This structure defines the core data for a book.
 // It is designed to align closely with the `books` table in the database,
@@ -21,6 +22,7 @@ struct Book {
     int total_pages = 0;
     time_t add_date = 0;
     time_t last_read_time = 0;
+    ReadingPosition position; // Logical bookmark; takes precedence over current_page when valid
 
     // --- Extended Metadata ---
     std::string cover_image_path;
@@ -0,0 +1,132 @@
+#include "BookSearchIndex.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+// Paragraphs are grouped until a block holds about this many bytes.
+constexpr size_t kBlockBytes = 8 * 1024;
+
+inline unsigned char lower(char c) {
+    return static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+inline uint32_t trigram_at(const std::string& text, size_t i) {
+    return (static_cast<uint32_t>(lower(text[i])) << 16) |
+           (static_cast<uint32_t>(lower(text[i + 1])) << 8) |
+           static_cast<uint32_t>(lower(text[i + 2]));
+}
+
+void collect_trigrams(const std::string& text, std::vector<uint32_t>& trigrams) {
+    for (size_t i = 0; i + 3 <= text.size(); ++i) {
+        trigrams.push_back(trigram_at(text, i));
+    }
+}
+
+// Case-insensitive (ASCII) find of an already lower-cased needle.
+size_t find_lowered(const std::string& haystack, const std::string& needle, size_t from) {
+    auto it = std::search(haystack.begin() + from, haystack.end(), needle.begin(), needle.end(),
+                          [](char a, char b) { return lower(a) == static_cast<unsigned char>(b); });
+    return it == haystack.end() ? std::string::npos : static_cast<size_t>(it - haystack.begin());
+}
+}
+
+void BookSearchIndex::AddChapter(int chapter_index, const std::vector<std::string>& paragraphs) {
+    // Build the chapter's blocks and their trigrams without holding the lock.
+    std::vector<Block> blocks;
+    std::vector<std::vector<uint32_t>> block_trigrams;
+    for (int p = 0; p < static_cast<int>(paragraphs.size());) {
+        Block block{chapter_index, p, 0, &paragraphs[p]};
+        std::vector<uint32_t> trigrams;
+        size_t bytes = 0;
+        while (p < static_cast<int>(paragraphs.size()) && (block.paragraph_count == 0 || bytes + paragraphs[p].size() <= kBlockBytes)) {
+            collect_trigrams(paragraphs[p], trigrams);
+            bytes += paragraphs[p].size();
+            block.paragraph_count++;
+            p++;
+        }
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+        blocks.push_back(block);
+        block_trigrams.push_back(std::move(trigrams));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        uint32_t block_id = blocks_.size();
+        for (uint32_t trigram : block_trigrams[i]) {
+            postings_[trigram].push_back(block_id);
+        }
+        blocks_.push_back(blocks[i]);
+    }
+}
+
+std::vector<ReadingPosition> BookSearchIndex::Search(const std::string& query, size_t limit) {
+    std::string needle;
+    for (char c : query) {
+        needle.push_back(static_cast<char>(lower(c)));
+    }
+    if (needle.empty()) {
+        return {};
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (needle != cached_query_) {
+        cached_query_ = needle;
+        cached_block_count_ = 0;
+        cached_hits_.clear();
+    }
+    if (cached_block_count_ == blocks_.size() || cached_hits_.size() >= limit) {
+        return cached_hits_;
+    }
+
+    // Candidate blocks among those not searched yet for this query.
+    uint32_t first_new = cached_block_count_;
+    std::vector<uint32_t> candidates;
+    if (needle.size() < 3) {
+        for (uint32_t id = first_new; id < blocks_.size(); ++id) candidates.push_back(id);
+    } else {
+        std::vector<uint32_t> trigrams;
+        collect_trigrams(needle, trigrams);
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+        std::vector<const std::vector<uint32_t>*> lists;
+        for (uint32_t trigram : trigrams) {
+            auto it = postings_.find(trigram);
+            if (it == postings_.end()) {
+                lists.clear();
+                break;
+            }
+            lists.push_back(&it->second);
+        }
+        if (!lists.empty()) {
+            std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+            candidates.assign(std::lower_bound(lists[0]->begin(), lists[0]->end(), first_new), lists[0]->end());
+            std::vector<uint32_t> narrowed;
+            for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+                narrowed.clear();
+                std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(narrowed));
+                candidates.swap(narrowed);
+            }
+        }
+    }
+
+    SearchBlocks(needle, candidates, limit, cached_hits_);
+    cached_block_count_ = blocks_.size();
+    return cached_hits_;
+}
+
+void BookSearchIndex::SearchBlocks(const std::string& needle, const std::vector<uint32_t>& block_ids, size_t limit, std::vector<ReadingPosition>& hits) const {
+    for (uint32_t id : block_ids) {
+        const Block& block = blocks_[id];
+        for (int i = 0; i < block.paragraph_count; ++i) {
+            const std::string& paragraph = block.paragraphs[i];
+            for (size_t pos = find_lowered(paragraph, needle, 0); pos != std::string::npos; pos = find_lowered(paragraph, needle, pos + needle.size())) {
+                hits.push_back({block.chapter_index, block.first_paragraph + i, pos});
+                if (hits.size() >= limit) {
+                    return;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef BOOK_SEARCH_INDEX_H
+#define BOOK_SEARCH_INDEX_H
+
+#include "CommonTypes.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Full-text index over one book's paragraphs. Paragraphs are grouped into blocks of a few
+// kilobytes and each trigram maps to the blocks containing it; a query intersects those
+// lists and scans only the candidate blocks. Chapters are added one at a time from a
+// background thread while searches run against whatever has been indexed so far.
+class BookSearchIndex {
+public:
+    // Indexes one chapter. The paragraph strings are referenced, not copied, and must
+    // outlive the index.
+    void AddChapter(int chapter_index, const std::vector<std::string>& paragraphs);
+
+    // Returns matches in reading order, case-insensitive for ASCII, up to limit. Repeating
+    // the last query only scans what was indexed since, so it is effectively free.
+    std::vector<ReadingPosition> Search(const std::string& query, size_t limit);
+
+private:
+    struct Block {
+        int chapter_index;
+        int first_paragraph;
+        int paragraph_count;
+        const std::string* paragraphs; // First paragraph of the block
+    };
+
+    void SearchBlocks(const std::string& query, const std::vector<uint32_t>& block_ids, size_t limit, std::vector<ReadingPosition>& hits) const;
+
+    std::mutex mutex_; // Guards everything below
+    std::vector<Block> blocks_;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings_; // Trigram -> block ids, ascending
+
+    // The last query's results, extended as more blocks are indexed.
+    std::string cached_query_;
+    size_t cached_block_count_ = 0;
+    std::vector<ReadingPosition> cached_hits_;
+};
+
+#endif // BOOK_SEARCH_INDEX_H
@@ -2,10 +2,30 @@
 #include "HtmlRenderer.h"
 #include "DebugLogger.h"
 #include "PdfParser.h" // Include for dynamic_cast and PDF handling
+#include "PerfStats.h"
+#include <algorithm>
+#include <chrono>
 #include <numeric>
 
 using namespace ftxui;
 
+namespace {
+// Pages before/after the current one kept ready in the render cache. Covers a dual-page
+// spread plus the next spread in either direction.
+constexpr int kPrefetchBehind = 2;
+constexpr int kPrefetchAhead = 3;
+// Maximum number of search hits collected for one query.
+constexpr size_t kMaxSearchHits = 2000;
+// Minimum time between progress notifications while the search index builds.
+constexpr auto kSearchProgressInterval = std::chrono::milliseconds(250);
+// How long a burst of resizes has to settle before a background re-layout starts.
+constexpr auto kLayoutSettleTime = std::chrono::milliseconds(50);
+// Minimum time between progress notifications while a layout builds.
+constexpr auto kLayoutProgressInterval = std::chrono::milliseconds(250);
+// Wrapped chapters kept around for scroll mode.
+constexpr size_t kMaxCachedChapters = 8;
+}
+
 // --- UTF-8 and Word Wrapping Utilities ---
 
 // Modern UTF-8 conversion functions to replace deprecated std::codecvt_utf8
@@ -66,6 +86,14 @@ std::string u32_to_utf8(const std::u32string& u32_str) {
     }
     return result;
 }
+// Number of bytes the code point occupies when encoded as UTF-8.
+size_t utf8_length(char32_t codepoint) {
+    if (codepoint <= 0x7F) return 1;
+    if (codepoint <= 0x7FF) return 2;
+    if (codepoint <= 0xFFFF) return 3;
+    return 4;
+}
+
 int character_display_width(uint32_t c) {
     if (c >= 0x4E00 && c <= 0x9FFF) return 2;
     if (c >= 0x3000 && c <= 0x303F) return 2;
@@ -73,20 +101,20 @@ int character_display_width(uint32_t c) {
     return 1;
 }
 
-std::vector<std::string> word_wrap(const std::string& text, int width) {
+// Wraps text to the given display width. If line_offsets is provided, it receives the
+// byte offset into `text` at which each returned line starts.
+std::vector<std::string> word_wrap(const std::string& text, int width, std::vector<size_t>* line_offsets = nullptr) {
     std::vector<std::string> lines;
-    if (text.empty()) {
-        lines.push_back("");
-        return lines;
-    }
-    if (width <= 0) {
+    if (text.empty() || width <= 0) {
         lines.push_back(text);
+        if (line_offsets) line_offsets->push_back(0);
         return lines;
     }
 
     std::u32string u32_text = utf8_to_u32(text);
 
     size_t start = 0;
+    size_t byte_pos = 0; // Byte offset corresponding to `start`
     while (start < u32_text.length()) {
         size_t end = start;
         int current_width = 0;
@@ -119,14 +147,18 @@ std::vector<std::string> word_wrap(const std::string& text, int width) {
         }
 
         lines.push_back(u32_to_utf8(u32_text.substr(start, last_space - start)));
+        if (line_offsets) line_offsets->push_back(byte_pos);
+        byte_pos += lines.back().size();
         
         start = last_space;
         if (start < u32_text.length() && (u32_text[start] == U' ' || u32_text[start] == U'\n')) {
+            byte_pos += utf8_length(u32_text[start]);
             start++;
         }
     }
      if (start == u32_text.length() && !u32_text.empty() && u32_text.back() == U'\n') {
         lines.push_back("");
+        if (line_offsets) line_offsets->push_back(byte_pos);
     }
 
     return lines;
@@ -134,7 +166,6 @@ std::vector<std::string> word_wrap(const std::string& text, int width) {
 
 // --- BookViewModel Implementation ---
 
-// Helper to recursively flatten the chapter tree for pagination
 void flatten_chapters_for_pagination(const std::vector<BookChapter>& chapters, std::vector<BookChapter>& flat_list) {
     for (const auto& chapter : chapters) {
         flat_list.push_back(chapter);
@@ -142,9 +173,49 @@ void flatten_chapters_for_pagination(const std::vector<BookChapter>& chapters, s
     }
 }
 
-BookViewModel::BookViewModel(std::unique_ptr<IBookParser> parser) : parser_(std::move(parser)) {
+namespace {
+// Pages a chapter and its children take: paragraphs measured at full width, ignoring where
+// word wrap breaks early, plus the blank line after a chapter with text.
+int estimate_chapter_pages(const BookChapter& chapter, int width, int height) {
+    size_t lines = 0;
+    for (const auto& paragraph : chapter.paragraphs) {
+        int paragraph_width = 0;
+        for (char32_t c : utf8_to_u32(paragraph)) {
+            paragraph_width += character_display_width(c);
+        }
+        lines += std::max(1, (paragraph_width + width - 1) / width);
+    }
+    if (!chapter.paragraphs.empty()) lines++;
+    int pages = std::max<int>(1, (lines + height - 1) / height);
+    for (const auto& child : chapter.children) {
+        pages += estimate_chapter_pages(child, width, height);
+    }
+    return pages;
+}
+}
+
+int estimate_page_count(const std::vector<BookChapter>& chapters, int width, int height) {
+    if (width <= 0 || height <= 0) return 0;
+    int pages = 0;
+    for (const auto& chapter : chapters) {
+        pages += estimate_chapter_pages(chapter, width, height);
+    }
+    return pages;
+}
+
+namespace {
+void build_toc_entries(const std::vector<BookChapter>& chapters, int depth, std::vector<TocEntry>& entries) {
+    for (const auto& chapter : chapters) {
+        entries.push_back({chapter.title, depth, static_cast<int>(entries.size())});
+        build_toc_entries(chapter.children, depth + 1, entries);
+    }
+}
+}
+
+BookViewModel::BookViewModel(std::unique_ptr<IBookParser> parser, TaskExecutor& executor)
+    : executor_(executor), parser_(std::move(parser)) {
     DebugLogger::log("BookViewModel created.");
-    
+
     // Check if the book is a PDF
     if (dynamic_cast<PdfParser*>(parser_.get())) {
         is_pdf_ = true;
@@ -152,86 +223,388 @@ BookViewModel::BookViewModel(std::unique_ptr<IBookParser> parser) : parser_(std:
     } else {
         // For non-PDFs, immediately prepare the flat chapter list for pagination
         flatten_chapters_for_pagination(parser_->GetChapters(), flat_chapters_);
+        BuildOffsetIndex();
+    }
+    build_toc_entries(parser_->GetChapters(), 0, toc_entries_);
+    layout_ = std::make_shared<Layout>();
+}
+
+BookViewModel::~BookViewModel() {
+    // Each task is dropped if it has not started, or stops at its next check if it has.
+    stop_search_index_ = true;
+    search_index_task_.Cancel();
+    search_index_task_.Wait();
+
+    TaskHandle layout_task;
+    {
+        std::lock_guard<std::mutex> lock(layout_job_mutex_);
+        stop_layout_ = true;
+        layout_request_seq_++; // Cancels a build in flight
+        layout_task = layout_task_;
+    }
+    layout_cv_.notify_all();
+    layout_task.Cancel();
+    layout_task.Wait();
+
+    TaskHandle prefetch_task;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        stop_prefetch_ = true;
+        prefetch_task = prefetch_task_;
+    }
+    prefetch_task.Cancel();
+    prefetch_task.Wait();
+}
+
+bool BookViewModel::Paginate(int width, int height, const CancellationToken& cancel) {
+    auto layout = BuildLayout(width, height, [&cancel] { return cancel.IsCancelled(); });
+    if (cancel.IsCancelled()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(layout_mutex_);
+        layout_ = layout;
+    }
+    InvalidateRenderCache();
+    return true;
+}
+
+void BookViewModel::RequestLayout(int width, int height, std::function<void()> on_ready) {
+    {
+        std::lock_guard<std::mutex> lock(layout_job_mutex_);
+        pending_layout_ = std::make_unique<LayoutRequest>(LayoutRequest{width, height, std::move(on_ready)});
+        layout_request_seq_++;
+        layout_in_flight_ = true;
+        if (!layout_running_) {
+            layout_running_ = true;
+            layout_task_ = executor_.Submit(TaskPriority::UiCritical, [this] { RunLayouts(); });
+        }
+    }
+    layout_cv_.notify_one(); // Restarts the settle wait of a task already running
+}
+
+bool BookViewModel::IsLayoutPending() const {
+    return layout_in_flight_;
+}
+
+int BookViewModel::GetLayoutProgressPercent() const {
+    int chapter_count = flat_chapters_.size();
+    return chapter_count == 0 ? 100 : layout_progress_chapters_ * 100 / chapter_count;
+}
+
+bool BookViewModel::AdoptReadyLayout() {
+    {
+        std::lock_guard<std::mutex> lock(layout_mutex_);
+        if (!ready_layout_) {
+            return false;
+        }
+        layout_ = std::move(ready_layout_);
+        ready_layout_.reset();
+    }
+    InvalidateRenderCache();
+    return true;
+}
+
+void BookViewModel::RunLayouts() {
+    std::unique_lock<std::mutex> lock(layout_job_mutex_);
+    while (!stop_layout_ && pending_layout_) {
+        // Let a burst of resize events settle so only the final size gets laid out.
+        uint64_t seq = layout_request_seq_;
+        while (layout_cv_.wait_for(lock, kLayoutSettleTime, [&] { return stop_layout_ || layout_request_seq_ != seq; })) {
+            if (stop_layout_) {
+                break;
+            }
+            seq = layout_request_seq_;
+        }
+        if (stop_layout_) {
+            break;
+        }
+
+        std::unique_ptr<LayoutRequest> request = std::move(pending_layout_);
+        lock.unlock();
+
+        DebugLogger::log("[Layout] Background re-layout to " + std::to_string(request->width) + "x" + std::to_string(request->height));
+        layout_progress_chapters_ = 0;
+        layout_progress_pages_ = 0;
+        auto last_notified = std::chrono::steady_clock::now();
+        auto layout = BuildLayout(request->width, request->height, [this, seq] { return layout_request_seq_ != seq; },
+                                  [&](int chapters_done, int pages_done) {
+                                      layout_progress_chapters_ = chapters_done;
+                                      layout_progress_pages_ = pages_done;
+                                      auto now = std::chrono::steady_clock::now();
+                                      if (request->on_ready && now - last_notified >= kLayoutProgressInterval) {
+                                          last_notified = now;
+                                          request->on_ready();
+                                      }
+                                  });
+
+        lock.lock();
+        if (!layout) {
+            DebugLogger::log("[Layout] Superseded by a newer request; discarded.");
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> layout_lock(layout_mutex_);
+            ready_layout_ = layout;
+        }
+        if (layout_request_seq_ == seq) {
+            layout_in_flight_ = false;
+        }
+        if (request->on_ready) {
+            request->on_ready();
+        }
     }
+    layout_running_ = false;
+}
+
+std::shared_ptr<const Layout> BookViewModel::CurrentLayout() const {
+    std::lock_guard<std::mutex> lock(layout_mutex_);
+    return layout_;
 }
 
-void BookViewModel::Paginate(int width, int height) {
+std::shared_ptr<const Layout> BookViewModel::BuildLayout(int width, int height, const std::function<bool()>& is_cancelled,
+                                                         const std::function<void(int, int)>& on_progress) {
+    ScopedPerfTimer timer(PerfStage::Paginate);
+    auto layout = std::make_shared<Layout>();
+    layout->width = width;
+    layout->height = height;
+
     if (is_pdf_) {
         DebugLogger::log("--- Starting PDF Pagination Logic ---");
         auto* pdf_parser = static_cast<PdfParser*>(parser_.get());
-        total_pages_ = pdf_parser->GetTotalPages();
-        DebugLogger::log("[Paginate] PDF pagination complete. Total pages: " + std::to_string(total_pages_));
-        return;
+        std::lock_guard<std::mutex> lock(parser_mutex_);
+        layout->total_pages = pdf_parser->GetTotalPages();
+        DebugLogger::log("[Paginate] PDF pagination complete. Total pages: " + std::to_string(layout->total_pages));
+        return layout;
     }
 
     // --- Non-PDF Pagination Logic ---
-    all_lines_.clear();
-    pages_.clear();
-    page_to_chapter_index_.clear();
-    chapter_to_start_page_.assign(flat_chapters_.size(), 0);
+    auto& all_lines = layout->lines;
+    auto& pages = layout->pages;
+    auto& page_to_chapter_index = layout->page_to_chapter_index;
+    auto& chapter_to_start_page = layout->chapter_to_start_page;
+    chapter_to_start_page.assign(flat_chapters_.size(), 0);
     DebugLogger::log("--- Starting New Pagination Logic ---");
 
-    if (width <= 0 || height <= 0) return;
+    if (width <= 0 || height <= 0) return layout;
 
     size_t global_line_index = 0;
 
     for (int i = 0; i < flat_chapters_.size(); ++i) {
-        const auto& chapter = flat_chapters_[i];
-        
         // 1. Record the starting page for the current chapter.
-        chapter_to_start_page_[i] = pages_.size();
+        chapter_to_start_page[i] = pages.size();
 
-        // 2. Generate all lines for the current chapter.
-        std::vector<std::string> chapter_lines;
-        for (const auto& p_text : chapter.paragraphs) {
-            auto wrapped_lines = word_wrap(p_text, width);
-            chapter_lines.insert(chapter_lines.end(), wrapped_lines.begin(), wrapped_lines.end());
-        }
-        // Add a blank line after a chapter if it has content, for spacing.
-        if (!chapter.paragraphs.empty()) {
-            chapter_lines.push_back(""); 
+        // 2. Generate all lines for the current chapter, remembering where each one starts.
+        auto chapter = WrapChapter(i, width, is_cancelled);
+        if (!chapter) {
+            return nullptr;
         }
+        const auto& chapter_lines = chapter->lines;
 
         // 3. Paginate the current chapter's lines.
-        if (chapter_lines.empty()) {
-            // If a chapter is empty (e.g., a title-only entry), create a single blank page for it.
+        for (size_t j = 0; j < chapter_lines.size(); j += height) {
             Page page;
             page.start_line_index = global_line_index;
-            all_lines_.push_back(""); // Add a single empty line to represent the page content
-            page.end_line_index = ++global_line_index;
-            pages_.push_back(page);
-            page_to_chapter_index_.push_back(i);
-        } else {
-            for (size_t j = 0; j < chapter_lines.size(); j += height) {
-                Page page;
-                page.start_line_index = global_line_index;
-                
-                size_t end_of_page_in_chapter = std::min(j + height, chapter_lines.size());
-                all_lines_.insert(all_lines_.end(), chapter_lines.begin() + j, chapter_lines.begin() + end_of_page_in_chapter);
-                
-                global_line_index += (end_of_page_in_chapter - j);
-                page.end_line_index = global_line_index;
-                
-                pages_.push_back(page);
-                page_to_chapter_index_.push_back(i);
+            page.start_position = chapter->positions[j];
+
+            size_t end_of_page_in_chapter = std::min(j + height, chapter_lines.size());
+            all_lines.insert(all_lines.end(), chapter_lines.begin() + j, chapter_lines.begin() + end_of_page_in_chapter);
+
+            global_line_index += (end_of_page_in_chapter - j);
+            page.end_line_index = global_line_index;
+
+            pages.push_back(page);
+            page_to_chapter_index.push_back(i);
+        }
+        if (on_progress) {
+            on_progress(i + 1, pages.size());
+        }
+    }
+    layout->total_pages = pages.size();
+
+    DebugLogger::log("[Paginate] New pagination complete. Total pages created: " + std::to_string(pages.size()));
+    return layout;
+}
+
+std::shared_ptr<const BookViewModel::ChapterLines> BookViewModel::WrapChapter(int chapter_index, int width, const std::function<bool()>& is_cancelled) {
+    auto chapter_lines = std::make_shared<ChapterLines>();
+    auto& lines = chapter_lines->lines;
+    auto& positions = chapter_lines->positions;
+
+    if (is_pdf_) {
+        std::string text_content;
+        {
+            std::lock_guard<std::mutex> lock(parser_mutex_);
+            text_content = static_cast<PdfParser*>(parser_.get())->GetTextForPage(chapter_index);
+        }
+        std::vector<size_t> offsets;
+        lines = word_wrap(text_content, width, &offsets);
+        for (size_t offset : offsets) {
+            positions.push_back({chapter_index, 0, offset});
+        }
+    } else {
+        const auto& chapter = flat_chapters_[chapter_index];
+        for (int p = 0; p < static_cast<int>(chapter.paragraphs.size()); ++p) {
+            if (is_cancelled && is_cancelled()) {
+                return nullptr;
+            }
+            std::vector<size_t> offsets;
+            auto wrapped_lines = word_wrap(chapter.paragraphs[p], width, &offsets);
+            lines.insert(lines.end(), wrapped_lines.begin(), wrapped_lines.end());
+            for (size_t offset : offsets) {
+                positions.push_back({chapter_index, p, offset});
             }
         }
+        // Add a blank line after a chapter if it has content, for spacing.
+        if (!chapter.paragraphs.empty()) {
+            lines.push_back("");
+            positions.push_back({chapter_index, static_cast<int>(chapter.paragraphs.size()), 0});
+        }
     }
 
-    DebugLogger::log("[Paginate] New pagination complete. Total pages created: " + std::to_string(pages_.size()));
+    // If a chapter is empty (e.g., a title-only entry), give it a single blank line.
+    if (lines.empty()) {
+        lines.push_back("");
+        positions.push_back({chapter_index, 0, 0});
+    }
+    return chapter_lines;
+}
+
+std::shared_ptr<const BookViewModel::ChapterLines> BookViewModel::GetChapterLines(int chapter_index, int width) {
+    std::lock_guard<std::mutex> lock(chapter_lines_mutex_);
+    if (width != chapter_lines_width_) {
+        chapter_lines_.clear();
+        chapter_lines_width_ = width;
+    }
+    auto it = chapter_lines_.find(chapter_index);
+    if (it != chapter_lines_.end()) {
+        return it->second;
+    }
+
+    // Keep only the chapters nearest the one being read.
+    while (chapter_lines_.size() >= kMaxCachedChapters) {
+        auto first = chapter_lines_.begin();
+        auto last = std::prev(chapter_lines_.end());
+        if (chapter_index - first->first > last->first - chapter_index) {
+            chapter_lines_.erase(first);
+        } else {
+            chapter_lines_.erase(last);
+        }
+    }
+    auto chapter_lines = WrapChapter(chapter_index, width, nullptr);
+    chapter_lines_.emplace(chapter_index, chapter_lines);
+    return chapter_lines;
 }
 
 
 Elements BookViewModel::GetPageContent(int page_index, int width) {
+    return BuildPageContent(*CurrentLayout(), page_index, width);
+}
+
+Element BookViewModel::GetPageElement(int page_index, int width) {
+    ScopedPerfTimer timer(PerfStage::PageContent);
+    Element page_element;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        if (width != cache_width_) {
+            page_cache_.clear();
+            cache_width_ = width;
+        }
+        auto it = page_cache_.find(page_index);
+        if (it != page_cache_.end()) {
+            page_element = it->second;
+        }
+    }
+
+    if (!page_element) {
+        page_element = vbox(GetPageContent(page_index, width));
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        page_cache_[page_index] = page_element;
+    }
+
+    SchedulePrefetch(page_index);
+    return page_element;
+}
+
+void BookViewModel::InvalidateRenderCache() {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    page_cache_.clear();
+    prefetch_queue_.clear();
+    layout_generation_++;
+}
+
+void BookViewModel::SchedulePrefetch(int page_index) {
+    int total_pages = GetTotalPages();
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+
+    // Drop pages that have fallen out of the window around the reader.
+    for (auto it = page_cache_.begin(); it != page_cache_.end();) {
+        if (it->first < page_index - kPrefetchBehind || it->first > page_index + kPrefetchAhead) {
+            it = page_cache_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Queue the missing neighbours, nearest first, replacing any stale requests.
+    prefetch_queue_.clear();
+    for (int distance = 1; distance <= std::max(kPrefetchBehind, kPrefetchAhead); ++distance) {
+        int ahead = page_index + distance;
+        int behind = page_index - distance;
+        if (distance <= kPrefetchAhead && ahead < total_pages && !page_cache_.count(ahead)) {
+            prefetch_queue_.push_back(ahead);
+        }
+        if (distance <= kPrefetchBehind && behind >= 0 && !page_cache_.count(behind)) {
+            prefetch_queue_.push_back(behind);
+        }
+    }
+    if (prefetch_queue_.empty()) {
+        return;
+    }
+
+    if (!prefetch_running_) {
+        prefetch_running_ = true;
+        prefetch_task_ = executor_.Submit(TaskPriority::UiCritical, [this] { RunPrefetch(); });
+    }
+}
+
+void BookViewModel::RunPrefetch() {
+    std::unique_lock<std::mutex> lock(cache_mutex_);
+    while (!stop_prefetch_ && !prefetch_queue_.empty()) {
+        int page_index = prefetch_queue_.front();
+        prefetch_queue_.erase(prefetch_queue_.begin());
+        if (page_cache_.count(page_index)) {
+            continue;
+        }
+        uint64_t generation = layout_generation_;
+        int width = cache_width_;
+        lock.unlock();
+
+        Element page_element = vbox(BuildPageContent(*CurrentLayout(), page_index, width));
+
+        lock.lock();
+        // Discard the page if the layout changed while it was being built.
+        if (generation == layout_generation_ && width == cache_width_) {
+            page_cache_.emplace(page_index, page_element);
+        }
+    }
+    prefetch_running_ = false;
+}
+
+Elements BookViewModel::BuildPageContent(const Layout& layout, int page_index, int width) {
     Elements page_elements;
 
     if (is_pdf_) {
-        if (page_index < 0 || page_index >= total_pages_) {
+        if (page_index < 0 || page_index >= layout.total_pages) {
             return page_elements;
         }
         auto* pdf_parser = static_cast<PdfParser*>(parser_.get());
-        std::string text_content = pdf_parser->GetTextForPage(page_index);
-        
+        std::string text_content;
+        {
+            std::lock_guard<std::mutex> lock(parser_mutex_);
+            text_content = pdf_parser->GetTextForPage(page_index);
+        }
+
         // Handle case where a page is image-based and has no text
         if (text_content.empty()) {
             page_elements.push_back(text("--- This page contains no text ---") | dim | hcenter);
@@ -246,40 +619,78 @@ Elements BookViewModel::GetPageContent(int page_index, int width) {
     }
 
     // Non-PDF logic
-    if (page_index < 0 || page_index >= pages_.size()) {
+    if (page_index < 0 || page_index >= static_cast<int>(layout.pages.size())) {
         return page_elements;
     }
-    const auto& page = pages_[page_index];
+    const auto& page = layout.pages[page_index];
     for(size_t i = page.start_line_index; i < page.end_line_index; ++i) {
-        page_elements.push_back(text(all_lines_[i]));
+        page_elements.push_back(text(layout.lines[i]));
     }
     return page_elements;
 }
 
 int BookViewModel::GetTotalPages() const {
-    if (is_pdf_) {
-        return total_pages_;
-    }
-    return pages_.size();
+    return CurrentLayout()->total_pages;
 }
 
 std::string BookViewModel::GetPageTitleForPage(int page_index) {
+    auto layout = CurrentLayout();
     if (is_pdf_) {
-        return "Page " + std::to_string(page_index + 1) + " / " + std::to_string(total_pages_);
+        return "Page " + std::to_string(page_index + 1) + " / " + std::to_string(layout->total_pages);
     }
 
-    if (page_index < 0 || page_index >= page_to_chapter_index_.size()) {
+    if (page_index < 0 || page_index >= static_cast<int>(layout->page_to_chapter_index.size())) {
         return "Unknown Chapter";
     }
-    int chapter_idx = page_to_chapter_index_[page_index];
+    int chapter_idx = layout->page_to_chapter_index[page_index];
     return flat_chapters_[chapter_idx].title;
 }
 
 int BookViewModel::GetChapterStartPage(int chapter_index) const {
-    if (chapter_index < 0 || chapter_index >= chapter_to_start_page_.size()) {
+    auto layout = CurrentLayout();
+    if (chapter_index < 0 || chapter_index >= static_cast<int>(layout->chapter_to_start_page.size())) {
         return 0;
     }
-    return chapter_to_start_page_[chapter_index];
+    return layout->chapter_to_start_page[chapter_index];
+}
+
+int BookViewModel::GetChapterIndexForPage(int page_index) const {
+    auto layout = CurrentLayout();
+    if (page_index < 0 || page_index >= static_cast<int>(layout->page_to_chapter_index.size())) {
+        return -1;
+    }
+    return layout->page_to_chapter_index[page_index];
+}
+
+ReadingPosition BookViewModel::GetPositionForPage(int page_index) const {
+    auto layout = CurrentLayout();
+    if (is_pdf_) {
+        return {std::clamp(page_index, 0, std::max(0, layout->total_pages - 1)), 0, 0};
+    }
+    if (layout->pages.empty()) {
+        return {};
+    }
+    page_index = std::clamp(page_index, 0, static_cast<int>(layout->pages.size()) - 1);
+    return layout->pages[page_index].start_position;
+}
+
+int BookViewModel::GetPageForPosition(const ReadingPosition& position) const {
+    if (!position.IsValid()) {
+        return 0;
+    }
+    auto layout = CurrentLayout();
+    if (is_pdf_) {
+        return std::clamp(position.chapter_index, 0, std::max(0, layout->total_pages - 1));
+    }
+    // Pages are laid out in reading order, so their start positions are sorted and the
+    // page containing `position` is the last one starting at or before it.
+    const auto& pages = layout->pages;
+    auto it = std::upper_bound(pages.begin(), pages.end(), position,
+                               [](const ReadingPosition& pos, const Page& page) { return pos < page.start_position; });
+    if (it == pages.begin()) {
+        return 0;
+    }
+    return static_cast<int>(std::distance(pages.begin(), it)) - 1;
 }
 
 const std::vector<BookChapter>& BookViewModel::GetChapters() const {
@@ -290,3 +701,212 @@ const std::vector<BookChapter>& BookViewModel::GetChapters() const {
 const std::vector<BookChapter>& BookViewModel::GetFlatChapters() const {
     return flat_chapters_;
 }
+
+const std::vector<TocEntry>& BookViewModel::GetTocEntries() const {
+    return toc_entries_;
+}
+
+int BookViewModel::GetChapterCount() const {
+    if (is_pdf_) {
+        return CurrentLayout()->total_pages;
+    }
+    return flat_chapters_.size();
+}
+
+std::string BookViewModel::GetChapterTitle(int chapter_index) {
+    if (is_pdf_) {
+        return "Page " + std::to_string(chapter_index + 1) + " / " + std::to_string(GetChapterCount());
+    }
+    if (chapter_index < 0 || chapter_index >= static_cast<int>(flat_chapters_.size())) {
+        return "Unknown Chapter";
+    }
+    return flat_chapters_[chapter_index].title;
+}
+
+LineCursor BookViewModel::GetLineForPosition(const ReadingPosition& position, int width) {
+    int chapter_count = GetChapterCount();
+    if (!position.IsValid() || chapter_count == 0) {
+        return {};
+    }
+    LineCursor cursor;
+    cursor.chapter_index = std::min(position.chapter_index, chapter_count - 1);
+    const auto& positions = GetChapterLines(cursor.chapter_index, width)->positions;
+    auto it = std::upper_bound(positions.begin(), positions.end(), position);
+    cursor.line_index = it == positions.begin() ? 0 : static_cast<int>(std::distance(positions.begin(), it)) - 1;
+    return cursor;
+}
+
+ReadingPosition BookViewModel::GetPositionForLine(const LineCursor& cursor, int width) {
+    if (GetChapterCount() == 0) {
+        return {};
+    }
+    const auto& positions = GetChapterLines(cursor.chapter_index, width)->positions;
+    return positions[std::clamp(cursor.line_index, 0, static_cast<int>(positions.size()) - 1)];
+}
+
+LineCursor BookViewModel::MoveLines(LineCursor cursor, int delta, int width) {
+    int chapter_count = GetChapterCount();
+    if (chapter_count == 0) {
+        return {};
+    }
+    cursor.line_index += delta;
+    while (cursor.line_index < 0) {
+        if (cursor.chapter_index == 0) {
+            cursor.line_index = 0;
+            return cursor;
+        }
+        cursor.chapter_index--;
+        cursor.line_index += GetChapterLines(cursor.chapter_index, width)->lines.size();
+    }
+    while (true) {
+        int line_count = GetChapterLines(cursor.chapter_index, width)->lines.size();
+        if (cursor.line_index < line_count) {
+            return cursor;
+        }
+        if (cursor.chapter_index == chapter_count - 1) {
+            cursor.line_index = line_count - 1;
+            return cursor;
+        }
+        cursor.line_index -= line_count;
+        cursor.chapter_index++;
+    }
+}
+
+Elements BookViewModel::GetLines(const LineCursor& first, int count, int width) {
+    ScopedPerfTimer timer(PerfStage::PageContent);
+    Elements line_elements;
+    int chapter_count = GetChapterCount();
+    LineCursor cursor = first;
+    while (count > 0 && cursor.chapter_index < chapter_count) {
+        auto chapter = GetChapterLines(cursor.chapter_index, width);
+        for (; count > 0 && cursor.line_index < static_cast<int>(chapter->lines.size()); ++cursor.line_index, --count) {
+            line_elements.push_back(text(chapter->lines[cursor.line_index]));
+        }
+        cursor.chapter_index++;
+        cursor.line_index = 0;
+    }
+    return line_elements;
+}
+
+void BookViewModel::BuildOffsetIndex() {
+    chapter_byte_start_.reserve(flat_chapters_.size());
+    paragraph_byte_start_.reserve(flat_chapters_.size());
+    total_bytes_ = 0;
+    for (const auto& chapter : flat_chapters_) {
+        chapter_byte_start_.push_back(total_bytes_);
+        std::vector<size_t> paragraph_starts;
+        paragraph_starts.reserve(chapter.paragraphs.size());
+        size_t chapter_bytes = 0;
+        for (const auto& paragraph : chapter.paragraphs) {
+            paragraph_starts.push_back(chapter_bytes);
+            chapter_bytes += paragraph.size();
+        }
+        paragraph_byte_start_.push_back(std::move(paragraph_starts));
+        total_bytes_ += chapter_bytes;
+    }
+}
+
+ReadingPosition BookViewModel::GetPositionForFraction(double fraction) const {
+    fraction = std::clamp(fraction, 0.0, 1.0);
+    if (is_pdf_) {
+        int total_pages = GetTotalPages();
+        return {std::clamp(static_cast<int>(fraction * total_pages), 0, std::max(0, total_pages - 1)), 0, 0};
+    }
+    if (flat_chapters_.empty()) {
+        return {};
+    }
+    if (total_bytes_ == 0) {
+        return {0, 0, 0};
+    }
+
+    size_t target = std::min(static_cast<size_t>(fraction * total_bytes_), total_bytes_ - 1);
+    // Last chapter starting at or before the target; empty chapters share their start with
+    // the next one and are skipped.
+    auto chapter_it = std::upper_bound(chapter_byte_start_.begin(), chapter_byte_start_.end(), target) - 1;
+    int chapter_index = std::distance(chapter_byte_start_.begin(), chapter_it);
+    size_t within_chapter = target - *chapter_it;
+
+    const auto& paragraph_starts = paragraph_byte_start_[chapter_index];
+    if (paragraph_starts.empty()) {
+        return {chapter_index, 0, 0};
+    }
+    auto paragraph_it = std::upper_bound(paragraph_starts.begin(), paragraph_starts.end(), within_chapter) - 1;
+    int paragraph_index = std::distance(paragraph_starts.begin(), paragraph_it);
+    return {chapter_index, paragraph_index, within_chapter - *paragraph_it};
+}
+
+double BookViewModel::GetFractionForPosition(const ReadingPosition& position) const {
+    if (!position.IsValid()) {
+        return 0.0;
+    }
+    if (is_pdf_) {
+        int total_pages = GetTotalPages();
+        return total_pages > 0 ? static_cast<double>(position.chapter_index) / total_pages : 0.0;
+    }
+    if (total_bytes_ == 0) {
+        return 0.0;
+    }
+    if (position.chapter_index >= static_cast<int>(chapter_byte_start_.size())) {
+        return 1.0;
+    }
+
+    const auto& paragraph_starts = paragraph_byte_start_[position.chapter_index];
+    size_t offset = chapter_byte_start_[position.chapter_index];
+    if (position.paragraph_index < static_cast<int>(paragraph_starts.size())) {
+        offset += paragraph_starts[position.paragraph_index] + position.byte_offset;
+    } else {
+        // Past the last paragraph: the end of the chapter
+        size_t next_chapter = position.chapter_index + 1;
+        offset = next_chapter < chapter_byte_start_.size() ? chapter_byte_start_[next_chapter] : total_bytes_;
+    }
+    return std::min(1.0, static_cast<double>(offset) / total_bytes_);
+}
+
+void BookViewModel::StartSearchIndex(std::function<void()> on_progress) {
+    if (search_index_started_) {
+        return;
+    }
+    search_index_started_ = true;
+    search_index_task_ = executor_.Submit(TaskPriority::Background, [this, on_progress = std::move(on_progress)] {
+        SearchIndexLoop(on_progress);
+    });
+}
+
+void BookViewModel::SearchIndexLoop(std::function<void()> on_progress) {
+    int chapter_count = GetChapterCount();
+    if (is_pdf_) {
+        pdf_page_text_.resize(chapter_count); // Never resized again, so indexed pages stay put
+    }
+    auto last_notified = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < chapter_count; ++i) {
+        if (stop_search_index_) {
+            return;
+        }
+        if (is_pdf_) {
+            std::lock_guard<std::mutex> lock(parser_mutex_);
+            pdf_page_text_[i].push_back(static_cast<PdfParser*>(parser_.get())->GetTextForPage(i));
+        }
+        search_index_.AddChapter(i, is_pdf_ ? pdf_page_text_[i] : flat_chapters_[i].paragraphs);
+        indexed_chapters_ = i + 1;
+
+        auto now = std::chrono::steady_clock::now();
+        if (on_progress && now - last_notified >= kSearchProgressInterval) {
+            last_notified = now;
+            on_progress();
+        }
+    }
+    DebugLogger::log("[Search] Indexed " + std::to_string(chapter_count) + " chapters.");
+    if (on_progress) {
+        on_progress();
+    }
+}
+
+std::vector<ReadingPosition> BookViewModel::Search(const std::string& query) {
+    return search_index_.Search(query, kMaxSearchHits);
+}
+
+int BookViewModel::GetSearchIndexProgress() const {
+    int chapter_count = GetChapterCount();
+    return chapter_count == 0 ? 100 : indexed_chapters_ * 100 / chapter_count;
+}
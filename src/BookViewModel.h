@@ -1,8 +1,19 @@
 #ifndef BOOK_VIEW_MODEL_H
 #define BOOK_VIEW_MODEL_H
 
+#include "BookSearchIndex.h"
+#include "CancellationToken.h"
+#include "CommonTypes.h"
 #include "IBookParser.h"
+#include "TaskExecutor.h"
 #include "ftxui/dom/elements.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 
@@ -12,31 +23,193 @@ using namespace ftxui;
 struct Page {
     size_t start_line_index;
     size_t end_line_index;
+    ReadingPosition start_position; // Logical position of the page's first line
 };
 
+// An immutable pagination result for one page size. Layouts are built off the UI thread
+// and swapped in whole, so readers never observe a half-built one.
+struct Layout {
+    int width = 0;
+    int height = 0;
+    int total_pages = 0;
+    std::vector<std::string> lines; // All lines from all chapters, concatenated.
+    std::vector<Page> pages;
+    std::vector<int> page_to_chapter_index; // Maps a page index to its chapter index in the flat chapter list
+    std::vector<int> chapter_to_start_page; // Maps a chapter index in the flat chapter list to its start page
+};
+
+// A line in scroll mode, addressed relative to its chapter so that only the chapters
+// around the viewport ever need to be wrapped.
+struct LineCursor {
+    int chapter_index = 0;
+    int line_index = 0;
+};
+
+// One row of the table of contents. chapter_index refers to the flat chapter list.
+struct TocEntry {
+    std::string title;
+    int depth = 0;
+    int chapter_index = 0;
+};
+
+// Flattens the chapter tree in reading (pre-order) order. ReadingPosition::chapter_index
+// indexes into this list.
+void flatten_chapters_for_pagination(const std::vector<BookChapter>& chapters, std::vector<BookChapter>& flat_list);
+// Approximate page count for a width x height page without building a layout; a little
+// low, since it does not account for word wrap. Not meaningful for PDFs.
+int estimate_page_count(const std::vector<BookChapter>& chapters, int width, int height);
+
+// Background layout, prefetch and search indexing run as tasks on executor. The
+// destructor waits for those still running, so never destroy a model from one of them.
 class BookViewModel {
 public:
-    BookViewModel(std::unique_ptr<IBookParser> parser);
+    BookViewModel(std::unique_ptr<IBookParser> parser, TaskExecutor& executor);
+    ~BookViewModel();
+
+    // Lays the book out synchronously and makes the result current. Returns false, leaving
+    // the current layout untouched, if the token was cancelled part way through.
+    bool Paginate(int width, int height, const CancellationToken& cancel = CancellationToken());
+    // Queues a background re-layout. A newer request cancels the one in flight, so rapid
+    // resizes only lay out the final size. The current layout stays in use until
+    // AdoptReadyLayout() swaps the new one in; on_ready is called from the worker thread,
+    // periodically while the build progresses and once when it is ready.
+    void RequestLayout(int width, int height, std::function<void()> on_ready);
+    // Swaps in a finished background layout. Call from the UI thread; returns true if the
+    // layout changed, in which case page indices must be re-derived from positions.
+    bool AdoptReadyLayout();
+    bool IsLayoutPending() const;
+    // Progress of the build in flight, for showing a live page count before it is adopted.
+    int GetLayoutProgressPages() const { return layout_progress_pages_; }
+    int GetLayoutProgressPercent() const;
 
-    void Paginate(int width, int height);
     Elements GetPageContent(int page_index, int width);
+    // Returns the page as a ready-made element from the render cache, building it on a miss.
+    // Neighbouring pages are prefetched in the background; the cache is dropped on re-layout.
+    Element GetPageElement(int page_index, int width);
     int GetTotalPages() const;
     std::string GetPageTitleForPage(int page_index);
     int GetChapterStartPage(int chapter_index) const;
+    int GetChapterIndexForPage(int page_index) const; // -1 if the page has no chapter
+
+    // Mapping between pages of the current layout and layout-independent positions.
+    ReadingPosition GetPositionForPage(int page_index) const;
+    int GetPageForPosition(const ReadingPosition& position) const; // O(log n)
     const std::vector<BookChapter>& GetChapters() const;
     const std::vector<BookChapter>& GetFlatChapters() const;
+    // The chapter tree flattened once per book, with nesting depth for indentation.
+    const std::vector<TocEntry>& GetTocEntries() const;
+
+    // --- Scroll mode ---
+    // Chapters (pages, for PDFs) are wrapped on demand and independently of the page
+    // layout, so the cost of a frame depends on the viewport height, not the book length.
+    int GetChapterCount() const;
+    std::string GetChapterTitle(int chapter_index);
+    LineCursor GetLineForPosition(const ReadingPosition& position, int width);
+    ReadingPosition GetPositionForLine(const LineCursor& cursor, int width);
+    // Moves the cursor by delta lines, crossing chapter boundaries and clamping at either end.
+    LineCursor MoveLines(LineCursor cursor, int delta, int width);
+    Elements GetLines(const LineCursor& first, int count, int width);
+
+    // --- Random access ---
+    // Resolved through a byte-offset index over all paragraphs that is built once at
+    // construction, so a percent jump needs no layout at all. O(log n).
+    ReadingPosition GetPositionForFraction(double fraction) const;
+    double GetFractionForPosition(const ReadingPosition& position) const;
+
+    // --- Full-text search ---
+    // Starts indexing the book as a Background task. Searches made before it finishes
+    // cover the part indexed so far; on_progress is called (from the worker) as more of
+    // the book becomes searchable, and once more when it is done.
+    void StartSearchIndex(std::function<void()> on_progress);
+    std::vector<ReadingPosition> Search(const std::string& query);
+    int GetSearchIndexProgress() const; // Percent of chapters indexed
 
 private:
+    void BuildOffsetIndex();
+    void SearchIndexLoop(std::function<void()> on_progress);
+
+    // One chapter word-wrapped at a given width. Never empty: a chapter without text
+    // still gets a blank line so it can be scrolled past and bookmarked.
+    struct ChapterLines {
+        std::vector<std::string> lines;
+        std::vector<ReadingPosition> positions; // Logical position of each line's first character
+    };
+    // Returns nullptr if is_cancelled reports true before the chapter is wrapped.
+    std::shared_ptr<const ChapterLines> WrapChapter(int chapter_index, int width, const std::function<bool()>& is_cancelled);
+    std::shared_ptr<const ChapterLines> GetChapterLines(int chapter_index, int width);
+
+    // Returns nullptr if is_cancelled reports true before the layout is finished.
+    // on_progress, if set, is called after each chapter with the chapters and pages done so far.
+    std::shared_ptr<const Layout> BuildLayout(int width, int height, const std::function<bool()>& is_cancelled,
+                                              const std::function<void(int, int)>& on_progress = nullptr);
+    std::shared_ptr<const Layout> CurrentLayout() const;
+    Elements BuildPageContent(const Layout& layout, int page_index, int width);
+    void InvalidateRenderCache();
+    void SchedulePrefetch(int page_index);
+    // Each runs until its queue is empty, then ends; the next request submits a new task.
+    void RunPrefetch();
+    void RunLayouts();
+
+    TaskExecutor& executor_;
     std::unique_ptr<IBookParser> parser_;
     std::vector<BookChapter> flat_chapters_; // A flattened list of all chapters, including children
-    std::vector<std::string> all_lines_; // All lines from all chapters, concatenated.
-    std::vector<Page> pages_;
-    std::vector<int> page_to_chapter_index_; // Maps a page index to its chapter index in the flat_chapters_ list
-    std::vector<int> chapter_to_start_page_; // Maps a chapter index in the flat_chapters_ list to its start page
+    std::vector<TocEntry> toc_entries_;
+
+    // Cumulative byte offsets: where each chapter starts in the book, and where each
+    // paragraph starts within its chapter.
+    std::vector<size_t> chapter_byte_start_;
+    std::vector<std::vector<size_t>> paragraph_byte_start_;
+    size_t total_bytes_ = 0;
+
+    // Full-text search index, filled in by search_index_task_.
+    BookSearchIndex search_index_;
+    std::vector<std::vector<std::string>> pdf_page_text_; // Indexed PDF text; one paragraph per page
+    std::atomic<int> indexed_chapters_{0};
+    std::atomic<bool> stop_search_index_{false};
+    bool search_index_started_ = false;
+    TaskHandle search_index_task_;
 
     // PDF-specific handling
     bool is_pdf_ = false;
-    int total_pages_ = 0;
+    std::mutex parser_mutex_; // PdfParser caches page text and is not thread-safe
+
+    // Current layout and the finished background layout waiting to be adopted.
+    mutable std::mutex layout_mutex_;
+    std::shared_ptr<const Layout> layout_;
+    std::shared_ptr<const Layout> ready_layout_;
+
+    // Background layout job. Each request bumps layout_request_seq_, which cancels the
+    // build in flight; the task only ever runs the latest pending request.
+    struct LayoutRequest {
+        int width;
+        int height;
+        std::function<void()> on_ready;
+    };
+    std::mutex layout_job_mutex_;
+    std::condition_variable layout_cv_;
+    std::unique_ptr<LayoutRequest> pending_layout_;
+    std::atomic<uint64_t> layout_request_seq_{0};
+    std::atomic<bool> layout_in_flight_{false};
+    std::atomic<int> layout_progress_chapters_{0};
+    std::atomic<int> layout_progress_pages_{0};
+    bool stop_layout_ = false;
+    bool layout_running_ = false; // A RunLayouts task is queued or running
+    TaskHandle layout_task_;
+
+    // Wrapped chapters for scroll mode, all at chapter_lines_width_.
+    std::mutex chapter_lines_mutex_;
+    std::map<int, std::shared_ptr<const ChapterLines>> chapter_lines_;
+    int chapter_lines_width_ = -1;
+
+    // Render cache; cache_mutex_ guards everything below it.
+    std::mutex cache_mutex_;
+    std::map<int, Element> page_cache_;
+    std::vector<int> prefetch_queue_; // Nearest pages first
+    int cache_width_ = -1;
+    uint64_t layout_generation_ = 0;
+    bool stop_prefetch_ = false;
+    bool prefetch_running_ = false; // A RunPrefetch task is queued or running
+    TaskHandle prefetch_task_;
 };
 
 #endif // BOOK_VIEW_MODEL_H
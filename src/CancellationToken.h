@@ -0,0 +1,21 @@
+#ifndef CANCELLATION_TOKEN_H
+#define CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <memory>
+
+// Cooperative cancellation for long-running work such as parsing or laying out a book.
+// The owner calls Cancel(); the worker polls IsCancelled() between units of work and
+// unwinds early. Copies share one flag, so a token can be handed to a thread by value.
+class CancellationToken {
+public:
+    CancellationToken() : cancelled_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void Cancel() const { cancelled_->store(true); }
+    bool IsCancelled() const { return cancelled_->load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+#endif // CANCELLATION_TOKEN_H
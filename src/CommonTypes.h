@@ -1,6 +1,9 @@
 #ifndef COMMON_TYPES_H
 #define COMMON_TYPES_H
 
+#include <cstddef>
+#include <tuple>
+
 enum class SyncStatus { IDLE, IN_PROGRESS, SUCCESS, ERROR };
 enum class DeleteScope {
     LocalOnly,      // 删除本地文件，DB记录更新为cloud-only
@@ -8,4 +11,24 @@ enum class DeleteScope {
     CloudAndLocal   // 彻底删除
 };
 
+// A layout-independent location in a book. Unlike a page index it stays valid
+// when the book is re-paginated (terminal resize, dual-page toggle).
+struct ReadingPosition {
+    int chapter_index = -1;  // Index into the flattened chapter list (page index for PDFs), -1 if unset
+    int paragraph_index = 0; // Paragraph within the chapter
+    size_t byte_offset = 0;  // Byte offset into the paragraph's UTF-8 text
+
+    bool IsValid() const { return chapter_index >= 0; }
+
+    bool operator<(const ReadingPosition& other) const {
+        return std::tie(chapter_index, paragraph_index, byte_offset) <
+               std::tie(other.chapter_index, other.paragraph_index, other.byte_offset);
+    }
+    bool operator==(const ReadingPosition& other) const {
+        return chapter_index == other.chapter_index &&
+               paragraph_index == other.paragraph_index &&
+               byte_offset == other.byte_offset;
+    }
+};
+
 #endif // COMMON_TYPES_H
@@ -57,6 +57,26 @@ void ConfigManager::SetLastPickerPath(const fs::path& path) {
     db_manager_.SetSetting("last_picker_path", path.string());
 }
 
+namespace {
+// Names stored in the library_sort setting, in LibrarySortKey order.
+const char* const kLibrarySortNames[kLibrarySortKeyCount] = {"recent", "title", "author", "added"};
+}
+
+LibrarySortKey ConfigManager::GetLibrarySortKey() const {
+    auto it = settings_.find("library_sort"); // Unset until the order is first changed
+    std::string name = it != settings_.end() ? it->second : "";
+    for (int i = 0; i < kLibrarySortKeyCount; ++i) {
+        if (name == kLibrarySortNames[i]) return static_cast<LibrarySortKey>(i);
+    }
+    return LibrarySortKey::Recent;
+}
+
+void ConfigManager::SetLibrarySortKey(LibrarySortKey sort_key) {
+    const char* name = kLibrarySortNames[static_cast<int>(sort_key)];
+    settings_["library_sort"] = name;
+    db_manager_.SetSetting("library_sort", name);
+}
+
 void ConfigManager::setGoogleCredentials(const std::string& clientId, const std::string& clientSecret) {
     settings_["client_id"] = clientId;
     settings_["client_secret"] = clientSecret;
@@ -23,6 +23,8 @@ public:
     std::string GetRefreshToken() const;
     void SetRefreshToken(const std::string& token);
     void SetLastPickerPath(const fs::path& path);
+    LibrarySortKey GetLibrarySortKey() const;
+    void SetLibrarySortKey(LibrarySortKey sort_key);
 
     // New methods for Google Credentials
     void setGoogleCredentials(const std::string& clientId, const std::string& clientSecret);
@@ -7,6 +7,186 @@
 #include <vector>
 #include <algorithm>
 #include <filesystem>
+#include <cctype>
+#include <chrono>
+#include <type_traits>
+
+// Column list shared by every query that materializes a full Book; keep in sync with ReadBookRow.
+#define BOOK_COLUMNS "uuid, title, author, path, hash, current_page, total_pages, last_read_time, add_date, cover_image_path, format, pdf_content_type, pdf_health_status, ocr_status, sync_status, google_drive_file_id, position_chapter, position_paragraph, position_offset"
+
+namespace {
+
+std::string column_text(sqlite3_stmt* stmt, int col, const char* fallback = "") {
+    const char* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+    return value ? value : fallback;
+}
+
+// Reads a row selected with BOOK_COLUMNS into a Book.
+Book ReadBookRow(sqlite3_stmt* stmt) {
+    Book book;
+    book.uuid = column_text(stmt, 0);
+    book.title = column_text(stmt, 1);
+    book.author = column_text(stmt, 2);
+    book.path = column_text(stmt, 3);
+    book.hash = column_text(stmt, 4);
+    book.current_page = sqlite3_column_int(stmt, 5);
+    book.total_pages = sqlite3_column_int(stmt, 6);
+    book.last_read_time = sqlite3_column_int64(stmt, 7);
+    book.add_date = sqlite3_column_int64(stmt, 8);
+    book.cover_image_path = column_text(stmt, 9);
+    book.format = column_text(stmt, 10);
+    book.pdf_content_type = column_text(stmt, 11, "unknown");
+    book.pdf_health_status = column_text(stmt, 12, "unchecked");
+    book.ocr_status = column_text(stmt, 13, "none");
+    book.sync_status = column_text(stmt, 14, "local");
+    book.google_drive_file_id = column_text(stmt, 15);
+    if (sqlite3_column_type(stmt, 16) != SQLITE_NULL) {
+        book.position.chapter_index = sqlite3_column_int(stmt, 16);
+        book.position.paragraph_index = sqlite3_column_int(stmt, 17);
+        book.position.byte_offset = static_cast<size_t>(sqlite3_column_int64(stmt, 18));
+    }
+    return book;
+}
+
+// Page queries for each LibrarySortKey, in enum order. Every ORDER BY matches one of the
+// library indexes column for column, and the keyset comparison uses the same collation,
+// so SQLite seeks into the index and stops after `limit` rows. The order includes uuid so
+// that rows with equal keys still page deterministically.
+struct PageQueries {
+    const char* first;
+    const char* after;
+    const char* at_offset;
+};
+#define BOOK_PAGE_QUERIES(keyset, order) { \
+    "SELECT " BOOK_COLUMNS " FROM books ORDER BY " order " LIMIT ?;", \
+    "SELECT " BOOK_COLUMNS " FROM books WHERE " keyset " ORDER BY " order " LIMIT ?;", \
+    "SELECT " BOOK_COLUMNS " FROM books ORDER BY " order " LIMIT ? OFFSET ?;" }
+const PageQueries kPageQueries[kLibrarySortKeyCount] = {
+    BOOK_PAGE_QUERIES("(last_read_time, uuid) < (?, ?)", "last_read_time DESC, uuid DESC"),
+    BOOK_PAGE_QUERIES("(title, uuid) > (? COLLATE NOCASE, ?)", "title COLLATE NOCASE, uuid"),
+    BOOK_PAGE_QUERIES("(author, uuid) > (? COLLATE NOCASE, ?)", "author COLLATE NOCASE, uuid"),
+    BOOK_PAGE_QUERIES("(add_date, uuid) < (?, ?)", "add_date DESC, uuid DESC"),
+};
+#undef BOOK_PAGE_QUERIES
+
+// How long queued progress and sync-status updates wait for more to batch with them.
+constexpr std::chrono::milliseconds kWriteBehindDelay(250);
+
+// The trigram tokenizer matches substrings of at least three characters.
+constexpr int kMinTextQueryChars = 3;
+
+int utf8_length(const std::string& text) {
+    int count = 0;
+    for (unsigned char c : text) {
+        if ((c & 0xC0) != 0x80) count++;
+    }
+    return count;
+}
+
+// Turns free text into an FTS5 query: every term becomes a quoted phrase, so punctuation and
+// FTS5 operators in the input are matched literally. Terms too short to match are dropped.
+std::string to_fts_query(const std::string& input) {
+    std::string query;
+    size_t i = 0;
+    while (i < input.size()) {
+        while (i < input.size() && std::isspace(static_cast<unsigned char>(input[i]))) i++;
+        size_t start = i;
+        while (i < input.size() && !std::isspace(static_cast<unsigned char>(input[i]))) i++;
+        std::string term = input.substr(start, i - start);
+        if (utf8_length(term) < kMinTextQueryChars) continue;
+        if (!query.empty()) query += " ";
+        query += '"';
+        for (char c : term) {
+            if (c == '"') query += '"';
+            query += c;
+        }
+        query += '"';
+    }
+    return query;
+}
+
+bool exec_sql(sqlite3* db, const char* sql, const char* what) {
+    char* err_msg = nullptr;
+    if (sqlite3_exec(db, sql, 0, 0, &err_msg) != SQLITE_OK) {
+        DebugLogger::log(std::string(what) + ": " + (err_msg ? err_msg : "unknown error"));
+        sqlite3_free(err_msg);
+        return false;
+    }
+    return true;
+}
+
+// A statement from DatabaseManager's cache, checked out for one call. Bind() takes the
+// parameters in order and picks the sqlite3_bind_* call from each argument's type. The
+// statement is reset and its bindings cleared when this goes out of scope, ready for the
+// next caller.
+class CachedStatement {
+public:
+    explicit CachedStatement(sqlite3_stmt* stmt) : stmt_(stmt) {}
+    ~CachedStatement() {
+        if (stmt_) Reset();
+    }
+    CachedStatement(const CachedStatement&) = delete;
+    CachedStatement& operator=(const CachedStatement&) = delete;
+
+    explicit operator bool() const { return stmt_ != nullptr; }
+    sqlite3_stmt* get() const { return stmt_; }
+
+    template <typename... Args>
+    CachedStatement& Bind(const Args&... args) {
+        int index = 1;
+        ((index = BindAt(index, args)), ...);
+        return *this;
+    }
+    int Step() { return sqlite3_step(stmt_); }
+    // For running the statement again within the same call, e.g. once per row of a batch.
+    void Reset() {
+        sqlite3_reset(stmt_);
+        sqlite3_clear_bindings(stmt_);
+    }
+
+private:
+    // Each overload returns the index of the parameter after the ones it bound. Text is
+    // copied, so temporaries are safe to pass.
+    int BindAt(int index, const std::string& value) {
+        sqlite3_bind_text(stmt_, index, value.c_str(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+        return index + 1;
+    }
+    int BindAt(int index, const char* value) {
+        sqlite3_bind_text(stmt_, index, value, -1, SQLITE_TRANSIENT);
+        return index + 1;
+    }
+    int BindAt(int index, std::nullptr_t) {
+        sqlite3_bind_null(stmt_, index);
+        return index + 1;
+    }
+    // A reading position fills three parameters: chapter, paragraph and byte offset, all
+    // NULL when it is not set.
+    int BindAt(int index, const ReadingPosition& position) {
+        if (position.IsValid()) {
+            sqlite3_bind_int(stmt_, index, position.chapter_index);
+            sqlite3_bind_int(stmt_, index + 1, position.paragraph_index);
+            sqlite3_bind_int64(stmt_, index + 2, static_cast<sqlite3_int64>(position.byte_offset));
+        } else {
+            sqlite3_bind_null(stmt_, index);
+            sqlite3_bind_null(stmt_, index + 1);
+            sqlite3_bind_null(stmt_, index + 2);
+        }
+        return index + 3;
+    }
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    int BindAt(int index, T value) {
+        if constexpr (sizeof(T) <= sizeof(int)) {
+            sqlite3_bind_int(stmt_, index, static_cast<int>(value));
+        } else {
+            sqlite3_bind_int64(stmt_, index, static_cast<sqlite3_int64>(value));
+        }
+        return index + 1;
+    }
+
+    sqlite3_stmt* stmt_;
+};
+
+} // namespace
 
 DatabaseManager::DatabaseManager(const std::string& db_path) : db_path_(db_path) {
     if (sqlite3_open(db_path.c_str(), &db_)) {
@@ -14,444 +194,841 @@ DatabaseManager::DatabaseManager(const std::string& db_path) : db_path_(db_path)
         db_ = nullptr;
     } else {
         DebugLogger::log("Opened database successfully: " + db_path);
+        // With a write-ahead log a commit is an append, and NORMAL syncs only at checkpoints;
+        // a crash can lose the last few commits but never corrupts the file.
+        exec_sql(db_, "PRAGMA journal_mode = WAL;", "Failed to enable WAL mode");
+        exec_sql(db_, "PRAGMA synchronous = NORMAL;", "Failed to set synchronous mode");
+        // So the row INSERT OR REPLACE removes fires the change-tracking delete trigger.
+        exec_sql(db_, "PRAGMA recursive_triggers = ON;", "Failed to enable recursive triggers");
+        writer_thread_ = std::thread(&DatabaseManager::WriterLoop, this);
     }
 }
 
 DatabaseManager::~DatabaseManager() {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        stop_writer_ = true;
+    }
+    pending_cv_.notify_all();
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
     if (db_) {
+        ApplyPendingWrites();
+        for (auto& [sql, stmt] : statement_cache_) {
+            sqlite3_finalize(stmt);
+        }
         sqlite3_close(db_);
         DebugLogger::log("Closed database.");
     }
 }
 
-void DatabaseManager::UpgradeSchema() {
-    if (!db_) return;
-    DebugLogger::log("Checking database schema...");
+sqlite3_stmt* DatabaseManager::Prepare(const char* sql, const char* caller) const {
+    auto it = statement_cache_.find(sql);
+    if (it != statement_cache_.end()) {
+        return it->second;
+    }
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v3(db_, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        DebugLogger::log(std::string(caller) + ": Failed to prepare statement: " + sqlite3_errmsg(db_));
+        sqlite3_finalize(stmt);
+        return nullptr;
+    }
+    statement_cache_.emplace(sql, stmt);
+    return stmt;
+}
 
-    const char* sql_check_uuid = "PRAGMA table_info(books);";
-    sqlite3_stmt* stmt;
-    bool uuid_exists = false;
-    bool sync_status_exists = false;
-    bool gdrive_id_exists = false;
-    bool format_exists = false;
-    bool cover_image_exists = false;
-
-    if (sqlite3_prepare_v2(db_, sql_check_uuid, -1, &stmt, 0) != SQLITE_OK) {
-        DebugLogger::log("Failed to prepare statement for schema check.");
-        return;
+std::unique_lock<std::recursive_mutex> DatabaseManager::Lock() const {
+    return std::unique_lock<std::recursive_mutex>(mutex_);
+}
+
+void DatabaseManager::QueueWrite(const char* kind, const std::string& uuid, std::function<bool()> apply,
+                                 std::function<void(Book&)> patch) {
+    std::string key = std::string(kind) + ":" + uuid;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        // A newer update of the same kind to the same book supersedes the queued one. It goes
+        // to the back, so the surviving updates still land in the order they were made.
+        pending_writes_.erase(std::remove_if(pending_writes_.begin(), pending_writes_.end(),
+                                             [&key](const PendingWrite& write) { return write.key == key; }),
+                              pending_writes_.end());
+        pending_writes_.push_back(PendingWrite{std::move(key), uuid, std::move(apply), std::move(patch)});
     }
+    pending_cv_.notify_one();
+}
 
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        std::string column_name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        if (column_name == "uuid") uuid_exists = true;
-        if (column_name == "sync_status") sync_status_exists = true;
-        if (column_name == "google_drive_file_id") gdrive_id_exists = true;
-        if (column_name == "format") format_exists = true;
-        if (column_name == "cover_image_path") cover_image_exists = true;
+void DatabaseManager::ApplyPendingWrites() const {
+    std::vector<PendingWrite> writes;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        writes.swap(pending_writes_);
     }
-    sqlite3_finalize(stmt);
+    if (writes.empty()) return;
 
-    char* err_msg = nullptr;
-    auto execute_sql = [&](const std::string& sql, const std::string& msg) {
-        if (sqlite3_exec(db_, sql.c_str(), 0, 0, &err_msg) != SQLITE_OK) {
-            DebugLogger::log(msg + ": " + err_msg);
-            sqlite3_free(err_msg);
+    // One transaction for the whole batch, unless the caller already has one open.
+    bool own_transaction = sqlite3_get_autocommit(db_) && exec_sql(db_, "BEGIN;", "ApplyPendingWrites: Failed to begin transaction");
+    for (const auto& write : writes) {
+        if (!write.apply()) {
+            DebugLogger::log("ApplyPendingWrites: Failed to apply " + write.key + ": " + std::string(sqlite3_errmsg(db_)));
         }
-    };
-
-    if (!uuid_exists) {
-        DebugLogger::log("Upgrading schema: adding 'uuid' column.");
-        execute_sql("ALTER TABLE books ADD COLUMN uuid TEXT;", "Failed to add 'uuid'");
     }
-    if (!sync_status_exists) {
-        DebugLogger::log("Upgrading schema: adding 'sync_status' column.");
-        execute_sql("ALTER TABLE books ADD COLUMN sync_status TEXT DEFAULT 'local';", "Failed to add 'sync_status'");
+    if (own_transaction) {
+        exec_sql(db_, "COMMIT;", "ApplyPendingWrites: Failed to commit");
     }
-    if (!gdrive_id_exists) {
-        DebugLogger::log("Upgrading schema: adding 'google_drive_file_id' column.");
-        execute_sql("ALTER TABLE books ADD COLUMN google_drive_file_id TEXT;", "Failed to add 'google_drive_file_id'");
+}
+
+Book DatabaseManager::ReadCurrentBookRow(sqlite3_stmt* stmt) const {
+    Book book = ReadBookRow(stmt);
+    // Readers hold mutex_, so the writer cannot be between taking the queue and committing it.
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    for (const auto& write : pending_writes_) {
+        if (write.uuid == book.uuid) {
+            write.patch(book);
+        }
     }
-    if (!format_exists) {
-        DebugLogger::log("Upgrading schema: adding 'format' column.");
-        execute_sql("ALTER TABLE books ADD COLUMN format TEXT;", "Failed to add 'format'");
+    return book;
+}
+
+void DatabaseManager::SetWritesAppliedCallback(std::function<void()> on_applied) {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    on_writes_applied_ = std::move(on_applied);
+}
+
+void DatabaseManager::WriterLoop() {
+    std::unique_lock<std::mutex> lock(pending_mutex_);
+    while (true) {
+        pending_cv_.wait(lock, [this] { return stop_writer_ || !pending_writes_.empty(); });
+        if (stop_writer_) return; // The destructor applies what is left
+        // Let a burst of updates, such as held-down page turns, gather into one transaction.
+        pending_cv_.wait_for(lock, kWriteBehindDelay, [this] { return stop_writer_; });
+        std::function<void()> on_applied = on_writes_applied_;
+        lock.unlock();
+        {
+            std::lock_guard<std::recursive_mutex> db_lock(mutex_);
+            ApplyPendingWrites();
+        }
+        if (on_applied) on_applied();
+        lock.lock();
     }
-    if (!cover_image_exists) {
-        DebugLogger::log("Upgrading schema: adding 'cover_image_path' column.");
-        execute_sql("ALTER TABLE books ADD COLUMN cover_image_path TEXT;", "Failed to add 'cover_image_path'");
+}
+
+namespace {
+bool has_column(sqlite3* db, const char* table, const std::string& column) {
+    std::string sql = std::string("PRAGMA table_info(") + table + ");";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) return false;
+    bool found = false;
+    while (!found && sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        found = name && column == name;
     }
+    sqlite3_finalize(stmt);
+    return found;
 }
 
+// ALTER TABLE ADD COLUMN fails if the column is there, so steps that add one check first.
+bool add_column(sqlite3* db, const char* table, const char* column, const char* definition) {
+    if (has_column(db, table, column)) return true;
+    std::string sql = std::string("ALTER TABLE ") + table + " ADD COLUMN " + column + " " + definition + ";";
+    return exec_sql(db, sql.c_str(), "Failed to add column");
+}
 
-bool DatabaseManager::InitDatabase() {
-    if (!db_) return false;
+// Creates a unique index on books(column) for non-empty values. A library from before the
+// index may already hold duplicates, which only ever cost a slower lookup; rather than
+// delete anyone's rows or fail the step, such a library gets a plain index of the same name.
+bool create_lookup_index(sqlite3* db, const char* name, const char* column) {
+    std::string where = std::string(" ON books(") + column + ") WHERE " + column + " IS NOT NULL AND " + column + " != '';";
+    std::string unique_sql = std::string("CREATE UNIQUE INDEX IF NOT EXISTS ") + name + where;
+    if (sqlite3_exec(db, unique_sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK) return true;
+    DebugLogger::log(std::string("Duplicate ") + column + " values in books; " + name + " is created without UNIQUE.");
+    std::string plain_sql = std::string("CREATE INDEX IF NOT EXISTS ") + name + where;
+    return exec_sql(db, plain_sql.c_str(), "Failed to create lookup index");
+}
 
-    const char* sql = R"(
-        CREATE TABLE IF NOT EXISTS books (
-            uuid TEXT PRIMARY KEY NOT NULL,
-            title TEXT NOT NULL,
-            author TEXT,
-            path TEXT,
-            hash TEXT,
-            cover_image_path TEXT,
-            add_date INTEGER,
-            last_read_time INTEGER,
-            current_page INTEGER DEFAULT 0,
-            total_pages INTEGER DEFAULT 0,
-            pdf_content_type TEXT,
-            pdf_health_status TEXT,
-            ocr_status TEXT DEFAULT 'none',
-            sync_status TEXT DEFAULT 'local',
-            google_drive_file_id TEXT,
-            format TEXT
-        );
-    )";
-    char* err_msg = nullptr;
-    if (sqlite3_exec(db_, sql, 0, 0, &err_msg) != SQLITE_OK) {
-        DebugLogger::log("Failed to create table: " + std::string(err_msg));
-        sqlite3_free(err_msg);
-        if (std::string(err_msg).find("table books already exists") == std::string::npos) {
+// Schema migrations. PRAGMA user_version records the last step applied; each step runs
+// in its own transaction together with the version bump, so a failed step leaves the
+// database at the previous version to be retried on the next start. Steps only create
+// what is missing, so they are safe on databases that already have part of the schema,
+// as every database from before versioning does. Append new steps; never edit old ones.
+struct Migration {
+    int version;
+    const char* description;
+    bool (*apply)(sqlite3* db);
+};
+
+const Migration kMigrations[] = {
+    {1, "books and systemInfo tables", [](sqlite3* db) {
+        if (!exec_sql(db, R"(
+            CREATE TABLE IF NOT EXISTS books (
+                uuid TEXT PRIMARY KEY NOT NULL,
+                title TEXT NOT NULL,
+                author TEXT,
+                path TEXT,
+                hash TEXT,
+                cover_image_path TEXT,
+                add_date INTEGER,
+                last_read_time INTEGER,
+                current_page INTEGER DEFAULT 0,
+                total_pages INTEGER DEFAULT 0,
+                pdf_content_type TEXT,
+                pdf_health_status TEXT,
+                ocr_status TEXT DEFAULT 'none',
+                sync_status TEXT DEFAULT 'local',
+                google_drive_file_id TEXT,
+                format TEXT,
+                position_chapter INTEGER,
+                position_paragraph INTEGER,
+                position_offset INTEGER
+            );
+            CREATE TABLE IF NOT EXISTS systemInfo (
+                key TEXT PRIMARY KEY NOT NULL,
+                value TEXT NOT NULL
+            );
+        )", "Failed to create tables")) return false;
+        // Columns added to books over time, before there were versions.
+        return add_column(db, "books", "uuid", "TEXT") &&
+               add_column(db, "books", "sync_status", "TEXT DEFAULT 'local'") &&
+               add_column(db, "books", "google_drive_file_id", "TEXT") &&
+               add_column(db, "books", "format", "TEXT") &&
+               add_column(db, "books", "cover_image_path", "TEXT") &&
+               add_column(db, "books", "position_chapter", "INTEGER") &&
+               add_column(db, "books", "position_paragraph", "INTEGER") &&
+               add_column(db, "books", "position_offset", "INTEGER");
+    }},
+    {2, "hash, path and recently-read indexes", [](sqlite3* db) {
+        // Keyset paging compares (key, uuid) row values, which never match a NULL.
+        return create_lookup_index(db, "idx_books_hash", "hash") &&
+               create_lookup_index(db, "idx_books_path", "path") && exec_sql(db, R"(
+            CREATE INDEX IF NOT EXISTS idx_books_recent ON books(last_read_time DESC, uuid DESC);
+            UPDATE books SET last_read_time = 0 WHERE last_read_time IS NULL;
+        )", "Failed to create indexes");
+    }},
+    {3, "full-text index tables", [](sqlite3* db) {
+        // The trigram tokenizer gives substring matching that also works for CJK text,
+        // which has no spaces for a word tokenizer to split on. Without FTS5 the step
+        // still counts as done; text search then stays unavailable.
+        exec_sql(db, "CREATE VIRTUAL TABLE IF NOT EXISTS book_text USING fts5(content, book_uuid UNINDEXED, chapter UNINDEXED, paragraph UNINDEXED, tokenize = 'trigram');",
+                 "Failed to create full-text table (is FTS5 enabled?)");
+        return exec_sql(db, "CREATE TABLE IF NOT EXISTS book_text_state (book_uuid TEXT PRIMARY KEY, hash TEXT, indexed_chapters INTEGER DEFAULT 0, complete INTEGER DEFAULT 0);",
+                        "Failed to create full-text state table");
+    }},
+    {4, "change tracking", [](sqlite3* db) {
+        // Every insert, update and delete on books takes the next number from
+        // library_changes.seq and stamps it on the row (or on a tombstone for a delete), so
+        // a reader that remembers the last number it saw can fetch just what changed since.
+        return add_column(db, "books", "row_version", "INTEGER NOT NULL DEFAULT 0") && exec_sql(db, R"(
+            CREATE TABLE IF NOT EXISTS library_changes (
+                id INTEGER PRIMARY KEY CHECK (id = 1),
+                seq INTEGER NOT NULL,
+                book_count INTEGER NOT NULL
+            );
+            INSERT OR IGNORE INTO library_changes (id, seq, book_count) VALUES (1, 0, (SELECT COUNT(*) FROM books));
+            CREATE TABLE IF NOT EXISTS book_tombstones (uuid TEXT PRIMARY KEY, row_version INTEGER NOT NULL);
+            CREATE INDEX IF NOT EXISTS idx_books_row_version ON books(row_version);
+
+            CREATE TRIGGER IF NOT EXISTS books_track_insert AFTER INSERT ON books BEGIN
+                UPDATE library_changes SET seq = seq + 1, book_count = book_count + 1 WHERE id = 1;
+                UPDATE books SET row_version = (SELECT seq FROM library_changes WHERE id = 1) WHERE rowid = NEW.rowid;
+                DELETE FROM book_tombstones WHERE uuid = NEW.uuid;
+            END;
+            -- The WHEN clause skips the trigger's own row_version stamp.
+            CREATE TRIGGER IF NOT EXISTS books_track_update AFTER UPDATE ON books WHEN NEW.row_version IS OLD.row_version BEGIN
+                UPDATE library_changes SET seq = seq + 1 WHERE id = 1;
+                UPDATE books SET row_version = (SELECT seq FROM library_changes WHERE id = 1) WHERE rowid = NEW.rowid;
+            END;
+            CREATE TRIGGER IF NOT EXISTS books_track_delete AFTER DELETE ON books BEGIN
+                UPDATE library_changes SET seq = seq + 1, book_count = book_count - 1 WHERE id = 1;
+                INSERT OR REPLACE INTO book_tombstones (uuid, row_version) VALUES (OLD.uuid, (SELECT seq FROM library_changes WHERE id = 1));
+            END;
+        )", "Failed to set up change tracking");
+    }},
+    {5, "title, author and add date indexes", [](sqlite3* db) {
+        // One index per sort order offered by GetBooksPage; see kPageQueries.
+        return exec_sql(db, R"(
+            CREATE INDEX IF NOT EXISTS idx_books_title ON books(title COLLATE NOCASE, uuid);
+            CREATE INDEX IF NOT EXISTS idx_books_author ON books(author COLLATE NOCASE, uuid);
+            CREATE INDEX IF NOT EXISTS idx_books_added ON books(add_date DESC, uuid DESC);
+            UPDATE books SET add_date = 0 WHERE add_date IS NULL;
+            UPDATE books SET author = '' WHERE author IS NULL;
+        )", "Failed to create sort indexes");
+    }},
+    {6, "file fingerprints", [](sqlite3* db) {
+        // Full hashes keyed by path and the stat they were taken under; see GetFileHash.
+        return exec_sql(db, R"(
+            CREATE TABLE IF NOT EXISTS file_fingerprints (
+                path TEXT PRIMARY KEY,
+                device INTEGER NOT NULL,
+                inode INTEGER NOT NULL,
+                size INTEGER NOT NULL,
+                mtime INTEGER NOT NULL,
+                sample_hash TEXT NOT NULL,
+                sha256 TEXT NOT NULL
+            );
+        )", "Failed to create file fingerprint table");
+    }},
+};
+constexpr int kSchemaVersion = sizeof(kMigrations) / sizeof(kMigrations[0]);
+}
+
+bool DatabaseManager::MigrateSchema() {
+    int version = 0;
+    {
+        CachedStatement stmt(Prepare("PRAGMA user_version;", "MigrateSchema"));
+        if (!stmt || stmt.Step() != SQLITE_ROW) return false;
+        version = sqlite3_column_int(stmt.get(), 0);
+    }
+    if (version == kSchemaVersion) {
+        return true;
+    }
+    if (version > kSchemaVersion) {
+        DebugLogger::log("Database schema version " + std::to_string(version) + " is newer than this build's " +
+                         std::to_string(kSchemaVersion) + "; leaving it as is.");
+        return true;
+    }
+
+    for (const Migration& migration : kMigrations) {
+        if (migration.version <= version) continue;
+        DebugLogger::log("Migrating database to schema version " + std::to_string(migration.version) + ": " + migration.description);
+        if (!exec_sql(db_, "BEGIN;", "MigrateSchema: Failed to begin transaction")) return false;
+        std::string set_version = "PRAGMA user_version = " + std::to_string(migration.version) + ";";
+        if (!migration.apply(db_) || !exec_sql(db_, set_version.c_str(), "MigrateSchema: Failed to record version") ||
+            !exec_sql(db_, "COMMIT;", "MigrateSchema: Failed to commit")) {
+            exec_sql(db_, "ROLLBACK;", "MigrateSchema: Failed to roll back");
+            DebugLogger::log("Schema migration " + std::to_string(migration.version) + " failed; staying at version " +
+                             std::to_string(migration.version - 1) + ".");
             return false;
         }
     }
-    
-    UpgradeSchema();
+    return true;
+}
 
-    char* err_msg2 = nullptr;
-    if (sqlite3_exec(db_, "CREATE UNIQUE INDEX IF NOT EXISTS idx_books_hash ON books(hash) WHERE hash IS NOT NULL AND hash != '';", 0, 0, &err_msg2) != SQLITE_OK) {
-        DebugLogger::log("Failed to create hash index: " + std::string(err_msg2));
-        sqlite3_free(err_msg2);
-    }
-    if (sqlite3_exec(db_, "CREATE UNIQUE INDEX IF NOT EXISTS idx_books_path ON books(path) WHERE path IS NOT NULL AND path != '';", 0, 0, &err_msg2) != SQLITE_OK) {
-        DebugLogger::log("Failed to create path index: " + std::string(err_msg2));
-        sqlite3_free(err_msg2);
+bool DatabaseManager::InitDatabase() {
+    auto lock = Lock();
+    if (!db_) return false;
+
+    if (!MigrateSchema()) {
+        // The tables later code relies on may be missing; the caller cannot go on.
+        DebugLogger::log("Database schema is incomplete; see the migration errors above.");
+        return false;
     }
 
+    // Change-tracking readers live in this process and start from the current sequence,
+    // so tombstones left by an earlier run are never read.
+    exec_sql(db_, "DELETE FROM book_tombstones;", "Failed to clear tombstones");
+
+    CachedStatement fts(Prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'book_text';", "InitDatabase"));
+    text_search_available_ = fts && fts.Step() == SQLITE_ROW;
+
     DebugLogger::log("Database initialized or upgraded successfully.");
     return true;
 }
 
 bool DatabaseManager::AddBook(const Book& book) {
+    auto lock = Lock();
+    return InsertBook(book);
+}
+
+std::vector<bool> DatabaseManager::AddBooks(const std::vector<Book>& books) {
+    auto lock = Lock();
+    std::vector<bool> added(books.size(), false);
+    if (!db_ || books.empty()) return added;
+
+    // One transaction per batch: a single fsync instead of one per book.
+    bool own_transaction = sqlite3_get_autocommit(db_) && exec_sql(db_, "BEGIN;", "AddBooks: Failed to begin transaction");
+    for (size_t i = 0; i < books.size(); ++i) {
+        added[i] = InsertBook(books[i]);
+    }
+    if (own_transaction && !exec_sql(db_, "COMMIT;", "AddBooks: Failed to commit")) {
+        exec_sql(db_, "ROLLBACK;", "AddBooks: Failed to roll back");
+        std::fill(added.begin(), added.end(), false);
+    }
+    return added;
+}
+
+bool DatabaseManager::InsertBook(const Book& book) {
     if (!db_ || book.uuid.empty()) return false;
 
-    const char* sql = R"(
+    CachedStatement stmt(Prepare(R"(
         INSERT OR REPLACE INTO books (
             uuid, title, author, path, hash, cover_image_path, add_date, last_read_time,
             current_page, total_pages, pdf_content_type, pdf_health_status, ocr_status,
-            sync_status, google_drive_file_id, format
-        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
-    )";
-    sqlite3_stmt* stmt;
-
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) {
-        DebugLogger::log("AddBook: Failed to prepare statement: " + std::string(sqlite3_errmsg(db_)));
-        return false;
-    }
-
-    sqlite3_bind_text(stmt, 1, book.uuid.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, book.title.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, book.author.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 4, book.path.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 5, book.hash.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 6, book.cover_image_path.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int64(stmt, 7, book.add_date);
-    sqlite3_bind_int64(stmt, 8, book.last_read_time);
-    sqlite3_bind_int(stmt, 9, book.current_page);
-    sqlite3_bind_int(stmt, 10, book.total_pages);
-    sqlite3_bind_text(stmt, 11, book.pdf_content_type.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 12, book.pdf_health_status.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 13, book.ocr_status.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 14, book.sync_status.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 15, book.google_drive_file_id.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 16, book.format.c_str(), -1, SQLITE_TRANSIENT);
-
-    if (sqlite3_step(stmt) != SQLITE_DONE) {
+            sync_status, google_drive_file_id, format,
+            position_chapter, position_paragraph, position_offset
+        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+    )", "AddBook"));
+    if (!stmt) return false;
+
+    stmt.Bind(book.uuid, book.title, book.author, book.path, book.hash, book.cover_image_path,
+              book.add_date, book.last_read_time, book.current_page, book.total_pages,
+              book.pdf_content_type, book.pdf_health_status, book.ocr_status,
+              book.sync_status, book.google_drive_file_id, book.format, book.position);
+
+    if (stmt.Step() != SQLITE_DONE) {
         DebugLogger::log("AddBook: Failed to execute statement: " + std::string(sqlite3_errmsg(db_)));
-        sqlite3_finalize(stmt);
         return false;
     }
 
-    sqlite3_finalize(stmt);
     DebugLogger::log("Successfully added/replaced book: " + book.title);
     return true;
 }
 
 bool DatabaseManager::BookExists(const std::string& hash) {
+    auto lock = Lock();
     if (!db_) return false;
-    const char* sql = "SELECT 1 FROM books WHERE hash = ?;";
-    sqlite3_stmt* stmt;
-    bool exists = false;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, hash.c_str(), -1, SQLITE_STATIC);
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            exists = true;
+    CachedStatement stmt(Prepare("SELECT 1 FROM books WHERE hash = ?;", "BookExists"));
+    return stmt && stmt.Bind(hash).Step() == SQLITE_ROW;
+}
+
+std::vector<Book> DatabaseManager::GetAllBooks() {
+    auto lock = Lock();
+    std::vector<Book> books;
+    if (!db_) return books;
+
+    CachedStatement stmt(Prepare("SELECT " BOOK_COLUMNS " FROM books ORDER BY last_read_time DESC;", "GetAllBooks"));
+    if (!stmt) return books;
+
+    while (stmt.Step() == SQLITE_ROW) {
+        books.push_back(ReadCurrentBookRow(stmt.get()));
+    }
+    return books;
+}
+
+int DatabaseManager::GetBookCount() {
+    auto lock = Lock();
+    if (!db_) return 0;
+    // Kept by the change-tracking triggers, so no table scan.
+    CachedStatement stmt(Prepare("SELECT book_count FROM library_changes WHERE id = 1;", "GetBookCount"));
+    if (!stmt || stmt.Step() != SQLITE_ROW) return 0;
+    return sqlite3_column_int(stmt.get(), 0);
+}
+
+int64_t DatabaseManager::GetLibraryChangeSequence() {
+    auto lock = Lock();
+    if (!db_) return 0;
+    CachedStatement stmt(Prepare("SELECT seq FROM library_changes WHERE id = 1;", "GetLibraryChangeSequence"));
+    if (!stmt || stmt.Step() != SQLITE_ROW) return 0;
+    return sqlite3_column_int64(stmt.get(), 0);
+}
+
+LibraryChanges DatabaseManager::GetLibraryChangesSince(int64_t since) {
+    auto lock = Lock();
+    LibraryChanges changes;
+    changes.sequence = since;
+    if (!db_) return changes;
+
+    CachedStatement head(Prepare("SELECT seq, book_count FROM library_changes WHERE id = 1;", "GetLibraryChangesSince"));
+    if (!head || head.Step() != SQLITE_ROW) return changes;
+    changes.sequence = sqlite3_column_int64(head.get(), 0);
+    changes.book_count = sqlite3_column_int(head.get(), 1);
+    if (changes.sequence == since) {
+        return changes;
+    }
+
+    CachedStatement changed(Prepare("SELECT " BOOK_COLUMNS " FROM books WHERE row_version > ? ORDER BY row_version;", "GetLibraryChangesSince"));
+    if (changed) {
+        changed.Bind(since);
+        while (changed.Step() == SQLITE_ROW) {
+            changes.changed.push_back(ReadCurrentBookRow(changed.get()));
         }
-    } else {
-        DebugLogger::log("BookExists: Failed to prepare statement: " + std::string(sqlite3_errmsg(db_)));
     }
-    sqlite3_finalize(stmt);
-    return exists;
+    CachedStatement deleted(Prepare("SELECT uuid FROM book_tombstones WHERE row_version > ?;", "GetLibraryChangesSince"));
+    if (deleted) {
+        deleted.Bind(since);
+        while (deleted.Step() == SQLITE_ROW) {
+            const char* uuid = reinterpret_cast<const char*>(sqlite3_column_text(deleted.get(), 0));
+            if (uuid) changes.deleted.push_back(uuid);
+        }
+    }
+    if (text_search_available_ && !changes.changed.empty()) {
+        // Same test as GetBookUuidsNeedingTextIndex, limited to the rows in this delta.
+        CachedStatement unindexed(Prepare(R"(
+            SELECT 1 FROM books b
+            LEFT JOIN book_text_state s ON s.book_uuid = b.uuid
+            WHERE b.row_version > ? AND b.path IS NOT NULL AND b.path != '' AND b.hash IS NOT NULL AND b.hash != ''
+              AND (s.book_uuid IS NULL OR s.hash IS NOT b.hash)
+            LIMIT 1;
+        )", "GetLibraryChangesSince"));
+        changes.needs_text_index = unindexed && unindexed.Bind(since).Step() == SQLITE_ROW;
+    }
+    return changes;
 }
 
-std::vector<Book> DatabaseManager::GetAllBooks() {
+LibraryCursor LibraryCursor::After(const Book& book, LibrarySortKey sort_key) {
+    LibraryCursor cursor;
+    cursor.uuid = book.uuid;
+    switch (sort_key) {
+        case LibrarySortKey::Recent:  cursor.time_key = book.last_read_time; break;
+        case LibrarySortKey::Title:   cursor.text_key = book.title; break;
+        case LibrarySortKey::Author:  cursor.text_key = book.author; break;
+        case LibrarySortKey::AddDate: cursor.time_key = book.add_date; break;
+    }
+    return cursor;
+}
+
+std::vector<Book> DatabaseManager::GetBooksPage(const LibraryCursor* after, int limit, LibrarySortKey sort_key) {
+    auto lock = Lock();
     std::vector<Book> books;
     if (!db_) return books;
 
-    const char* sql = "SELECT uuid, title, author, path, hash, current_page, total_pages, last_read_time, add_date, cover_image_path, format, pdf_content_type, pdf_health_status, ocr_status, sync_status, google_drive_file_id FROM books ORDER BY last_read_time DESC;";
-    sqlite3_stmt* stmt;
+    const PageQueries& queries = kPageQueries[static_cast<int>(sort_key)];
+    CachedStatement stmt(Prepare(after ? queries.after : queries.first, "GetBooksPage"));
+    if (!stmt) return books;
+    if (!after) {
+        stmt.Bind(limit);
+    } else if (sort_key == LibrarySortKey::Title || sort_key == LibrarySortKey::Author) {
+        stmt.Bind(after->text_key, after->uuid, limit);
+    } else {
+        stmt.Bind(after->time_key, after->uuid, limit);
+    }
 
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) {
-        DebugLogger::log("GetAllBooks: Failed to prepare statement: " + std::string(sqlite3_errmsg(db_)));
-        return books;
-    }
-
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Book book;
-        book.uuid = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        book.title = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        book.author = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        book.path = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        book.hash = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-        book.current_page = sqlite3_column_int(stmt, 5);
-        book.total_pages = sqlite3_column_int(stmt, 6);
-        book.last_read_time = sqlite3_column_int64(stmt, 7);
-        book.add_date = sqlite3_column_int64(stmt, 8);
-        const char* cover = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9));
-        book.cover_image_path = cover ? cover : "";
-        const char* format = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 10));
-        book.format = format ? format : "";
-        const char* content_type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 11));
-        book.pdf_content_type = content_type ? content_type : "unknown";
-        const char* health_status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 12));
-        book.pdf_health_status = health_status ? health_status : "unchecked";
-        const char* ocr_status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 13));
-        book.ocr_status = ocr_status ? ocr_status : "none";
-        const char* sync_status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 14));
-        book.sync_status = sync_status ? sync_status : "local";
-        const char* gdrive_id = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 15));
-        book.google_drive_file_id = gdrive_id ? gdrive_id : "";
-        books.push_back(book);
+    while (stmt.Step() == SQLITE_ROW) {
+        books.push_back(ReadCurrentBookRow(stmt.get()));
     }
+    return books;
+}
 
-    sqlite3_finalize(stmt);
+std::vector<Book> DatabaseManager::GetBooksPageAtOffset(int offset, int limit, LibrarySortKey sort_key) {
+    auto lock = Lock();
+    std::vector<Book> books;
+    if (!db_) return books;
+
+    CachedStatement stmt(Prepare(kPageQueries[static_cast<int>(sort_key)].at_offset, "GetBooksPageAtOffset"));
+    if (!stmt) return books;
+    stmt.Bind(limit, offset);
+
+    while (stmt.Step() == SQLITE_ROW) {
+        books.push_back(ReadCurrentBookRow(stmt.get()));
+    }
     return books;
 }
 
 std::optional<Book> DatabaseManager::GetBookByUUID(const std::string& uuid) {
+    auto lock = Lock();
     if (!db_) return std::nullopt;
-    const char* sql = "SELECT uuid, title, author, path, hash, current_page, total_pages, last_read_time, add_date, cover_image_path, format, pdf_content_type, pdf_health_status, ocr_status, sync_status, google_drive_file_id FROM books WHERE uuid = ?;";
-    sqlite3_stmt* stmt;
-
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) {
-        DebugLogger::log("GetBookByUUID: Failed to prepare statement: " + std::string(sqlite3_errmsg(db_)));
-        return std::nullopt;
-    }
-    sqlite3_bind_text(stmt, 1, uuid.c_str(), -1, SQLITE_STATIC);
-
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        Book book;
-        book.uuid = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        book.title = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        book.author = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        book.path = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        book.hash = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-        book.current_page = sqlite3_column_int(stmt, 5);
-        book.total_pages = sqlite3_column_int(stmt, 6);
-        book.last_read_time = sqlite3_column_int64(stmt, 7);
-        book.add_date = sqlite3_column_int64(stmt, 8);
-        const char* cover = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9));
-        book.cover_image_path = cover ? cover : "";
-        const char* format = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 10));
-        book.format = format ? format : "";
-        const char* content_type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 11));
-        book.pdf_content_type = content_type ? content_type : "unknown";
-        const char* health_status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 12));
-        book.pdf_health_status = health_status ? health_status : "unchecked";
-        const char* ocr_status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 13));
-        book.ocr_status = ocr_status ? ocr_status : "none";
-        const char* sync_status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 14));
-        book.sync_status = sync_status ? sync_status : "local";
-        const char* gdrive_id = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 15));
-        book.google_drive_file_id = gdrive_id ? gdrive_id : "";
-        sqlite3_finalize(stmt);
-        return book;
-    }
-    
-    sqlite3_finalize(stmt);
-    return std::nullopt;
+    CachedStatement stmt(Prepare("SELECT " BOOK_COLUMNS " FROM books WHERE uuid = ?;", "GetBookByUUID"));
+    if (!stmt || stmt.Bind(uuid).Step() != SQLITE_ROW) return std::nullopt;
+    return ReadCurrentBookRow(stmt.get());
 }
 
 std::optional<Book> DatabaseManager::GetBookByHash(const std::string& hash) {
+    auto lock = Lock();
     if (!db_) return std::nullopt;
-    const char* sql = "SELECT uuid, title, author, path, hash, current_page, total_pages, last_read_time, add_date, cover_image_path, format, pdf_content_type, pdf_health_status, ocr_status, sync_status, google_drive_file_id FROM books WHERE hash = ?;";
-    sqlite3_stmt* stmt;
-
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) {
-        DebugLogger::log("GetBookByHash: Failed to prepare statement: " + std::string(sqlite3_errmsg(db_)));
-        return std::nullopt;
-    }
-    sqlite3_bind_text(stmt, 1, hash.c_str(), -1, SQLITE_STATIC);
-
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        Book book;
-        book.uuid = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        book.title = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        book.author = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        book.path = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        book.hash = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-        book.current_page = sqlite3_column_int(stmt, 5);
-        book.total_pages = sqlite3_column_int(stmt, 6);
-        book.last_read_time = sqlite3_column_int64(stmt, 7);
-        book.add_date = sqlite3_column_int64(stmt, 8);
-        const char* cover = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9));
-        book.cover_image_path = cover ? cover : "";
-        const char* format = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 10));
-        book.format = format ? format : "";
-        const char* content_type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 11));
-        book.pdf_content_type = content_type ? content_type : "unknown";
-        const char* health_status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 12));
-        book.pdf_health_status = health_status ? health_status : "unchecked";
-        const char* ocr_status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 13));
-        book.ocr_status = ocr_status ? ocr_status : "none";
-        const char* sync_status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 14));
-        book.sync_status = sync_status ? sync_status : "local";
-        const char* gdrive_id = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 15));
-        book.google_drive_file_id = gdrive_id ? gdrive_id : "";
-        sqlite3_finalize(stmt);
-        return book;
-    }
-    
-    sqlite3_finalize(stmt);
-    return std::nullopt;
+    CachedStatement stmt(Prepare("SELECT " BOOK_COLUMNS " FROM books WHERE hash = ?;", "GetBookByHash"));
+    if (!stmt || stmt.Bind(hash).Step() != SQLITE_ROW) return std::nullopt;
+    return ReadCurrentBookRow(stmt.get());
 }
 
 bool DatabaseManager::UpdateProgress(const std::string& book_uuid, int current_page) {
     if (!db_) return false;
-    const char* sql = "UPDATE books SET current_page = ? WHERE uuid = ?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) return false;
-    sqlite3_bind_int(stmt, 1, current_page);
-    sqlite3_bind_text(stmt, 2, book_uuid.c_str(), -1, SQLITE_STATIC);
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    QueueWrite("UpdateProgress", book_uuid, [this, book_uuid, current_page] {
+        CachedStatement stmt(Prepare("UPDATE books SET current_page = ? WHERE uuid = ?;", "UpdateProgress"));
+        return stmt && stmt.Bind(current_page, book_uuid).Step() == SQLITE_DONE;
+    }, [current_page](Book& book) {
+        book.current_page = current_page;
+    });
+    return true;
 }
 
+// The page comes from a source without a logical position (e.g. the cloud), so any
+// stored position is cleared to keep it from overriding the newer page.
 bool DatabaseManager::UpdateProgressAndTimestamp(const std::string& book_uuid, int current_page, time_t last_read_time) {
     if (!db_) return false;
-    const char* sql = "UPDATE books SET current_page = ?, last_read_time = ? WHERE uuid = ?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) {
-        DebugLogger::log("UpdateProgressAndTimestamp: Failed to prepare statement: " + std::string(sqlite3_errmsg(db_)));
-        return false;
-    }
-    sqlite3_bind_int(stmt, 1, current_page);
-    sqlite3_bind_int64(stmt, 2, last_read_time);
-    sqlite3_bind_text(stmt, 3, book_uuid.c_str(), -1, SQLITE_STATIC);
-    
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    if (!success) {
-        DebugLogger::log("UpdateProgressAndTimestamp: Failed to execute statement: " + std::string(sqlite3_errmsg(db_)));
-    }
-    
-    sqlite3_finalize(stmt);
-    return success;
+    QueueWrite("UpdateProgressAndTimestamp", book_uuid, [this, book_uuid, current_page, last_read_time] {
+        CachedStatement stmt(Prepare("UPDATE books SET current_page = ?, last_read_time = ?, position_chapter = NULL, position_paragraph = NULL, position_offset = NULL WHERE uuid = ?;",
+                                     "UpdateProgressAndTimestamp"));
+        return stmt && stmt.Bind(current_page, last_read_time, book_uuid).Step() == SQLITE_DONE;
+    }, [current_page, last_read_time](Book& book) {
+        book.current_page = current_page;
+        book.last_read_time = last_read_time;
+        book.position = ReadingPosition();
+    });
+    return true;
+}
+
+bool DatabaseManager::UpdateProgressAndPosition(const std::string& book_uuid, int current_page, const ReadingPosition& position, time_t last_read_time) {
+    if (!db_) return false;
+    QueueWrite("UpdateProgressAndPosition", book_uuid, [this, book_uuid, current_page, position, last_read_time] {
+        CachedStatement stmt(Prepare("UPDATE books SET current_page = ?, last_read_time = ?, position_chapter = ?, position_paragraph = ?, position_offset = ? WHERE uuid = ?;",
+                                     "UpdateProgressAndPosition"));
+        return stmt && stmt.Bind(current_page, last_read_time, position, book_uuid).Step() == SQLITE_DONE;
+    }, [current_page, position, last_read_time](Book& book) {
+        book.current_page = current_page;
+        book.last_read_time = last_read_time;
+        book.position = position;
+    });
+    return true;
 }
 
 bool DatabaseManager::UpdateLastReadTime(const std::string& book_uuid) {
     if (!db_) return false;
-    const char* sql = "UPDATE books SET last_read_time = ? WHERE uuid = ?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) return false;
-    sqlite3_bind_int64(stmt, 1, std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
-    sqlite3_bind_text(stmt, 2, book_uuid.c_str(), -1, SQLITE_STATIC);
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    QueueWrite("UpdateLastReadTime", book_uuid, [this, book_uuid, now] {
+        CachedStatement stmt(Prepare("UPDATE books SET last_read_time = ? WHERE uuid = ?;", "UpdateLastReadTime"));
+        return stmt && stmt.Bind(now, book_uuid).Step() == SQLITE_DONE;
+    }, [now](Book& book) {
+        book.last_read_time = now;
+    });
+    return true;
 }
 
 bool DatabaseManager::DeleteBook(const std::string& book_uuid) {
+    auto lock = Lock();
     if (!db_) return false;
-    const char* sql = "DELETE FROM books WHERE uuid = ?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) return false;
-    sqlite3_bind_text(stmt, 1, book_uuid.c_str(), -1, SQLITE_STATIC);
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
+    CachedStatement delete_fingerprint(Prepare(
+        "DELETE FROM file_fingerprints WHERE path = (SELECT path FROM books WHERE uuid = ?);", "DeleteBook"));
+    if (delete_fingerprint) delete_fingerprint.Bind(book_uuid).Step();
+    CachedStatement stmt(Prepare("DELETE FROM books WHERE uuid = ?;", "DeleteBook"));
+    bool success = stmt && stmt.Bind(book_uuid).Step() == SQLITE_DONE;
+    if (success && text_search_available_) {
+        CachedStatement delete_text(Prepare("DELETE FROM book_text WHERE book_uuid = ?;", "DeleteBook"));
+        if (delete_text) delete_text.Bind(book_uuid).Step();
+        CachedStatement delete_state(Prepare("DELETE FROM book_text_state WHERE book_uuid = ?;", "DeleteBook"));
+        if (delete_state) delete_state.Bind(book_uuid).Step();
+    }
     return success;
 }
 
+std::string DatabaseManager::GetFileHash(const std::string& path) {
+    SystemUtils::FileStat stat;
+    if (!SystemUtils::GetFileStat(path, stat)) {
+        DebugLogger::log("ERROR: Could not stat file for hashing: " + path);
+        return "";
+    }
+
+    std::string recorded_sample;
+    std::string recorded_hash;
+    {
+        auto lock = Lock();
+        if (!db_) return "";
+        CachedStatement stmt(Prepare("SELECT sample_hash, sha256 FROM file_fingerprints "
+                                     "WHERE path = ? AND device = ? AND inode = ? AND size = ? AND mtime = ?;",
+                                     "GetFileHash"));
+        if (stmt && stmt.Bind(path, stat.device, stat.inode, stat.size, stat.mtime).Step() == SQLITE_ROW) {
+            recorded_sample = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0));
+            recorded_hash = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 1));
+        }
+    }
+
+    // The file is read without the lock held.
+    std::string sample_hash = SystemUtils::CalculateSampleHash(path);
+    if (!recorded_hash.empty() && !sample_hash.empty() && sample_hash == recorded_sample) {
+        return recorded_hash;
+    }
+    std::string sha256 = SystemUtils::CalculateFileHash(path);
+    if (!sha256.empty() && !sample_hash.empty()) {
+        StoreFileFingerprint(path, stat, sample_hash, sha256);
+    }
+    return sha256;
+}
+
+void DatabaseManager::RecordFileHash(const std::string& path, const std::string& sha256) {
+    SystemUtils::FileStat stat;
+    if (sha256.empty() || !SystemUtils::GetFileStat(path, stat)) return;
+    std::string sample_hash = SystemUtils::CalculateSampleHash(path);
+    if (!sample_hash.empty()) {
+        StoreFileFingerprint(path, stat, sample_hash, sha256);
+    }
+}
+
+void DatabaseManager::StoreFileFingerprint(const std::string& path, const SystemUtils::FileStat& stat,
+                                           const std::string& sample_hash, const std::string& sha256) {
+    auto lock = Lock();
+    if (!db_) return;
+    CachedStatement stmt(Prepare("INSERT OR REPLACE INTO file_fingerprints "
+                                 "(path, device, inode, size, mtime, sample_hash, sha256) VALUES (?, ?, ?, ?, ?, ?, ?);",
+                                 "StoreFileFingerprint"));
+    if (!stmt || stmt.Bind(path, stat.device, stat.inode, stat.size, stat.mtime, sample_hash, sha256).Step() != SQLITE_DONE) {
+        DebugLogger::log("WARNING: Could not record the fingerprint of " + path);
+    }
+}
+
 bool DatabaseManager::UpdateOcrStatus(const std::string& book_uuid, const std::string& status) {
+    auto lock = Lock();
     if (!db_) return false;
-    const char* sql = "UPDATE books SET ocr_status = ? WHERE uuid = ?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) return false;
-    sqlite3_bind_text(stmt, 1, status.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, book_uuid.c_str(), -1, SQLITE_STATIC);
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    CachedStatement stmt(Prepare("UPDATE books SET ocr_status = ? WHERE uuid = ?;", "UpdateOcrStatus"));
+    return stmt && stmt.Bind(status, book_uuid).Step() == SQLITE_DONE;
 }
 
 bool DatabaseManager::UpdatePdfHealthStatus(const std::string& book_uuid, const std::string& health_status, const std::string& content_type) {
+    auto lock = Lock();
     if (!db_) return false;
-    const char* sql = "UPDATE books SET pdf_health_status = ?, pdf_content_type = ? WHERE uuid = ?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) return false;
-    sqlite3_bind_text(stmt, 1, health_status.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, content_type.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, book_uuid.c_str(), -1, SQLITE_STATIC);
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    CachedStatement stmt(Prepare("UPDATE books SET pdf_health_status = ?, pdf_content_type = ? WHERE uuid = ?;", "UpdatePdfHealthStatus"));
+    return stmt && stmt.Bind(health_status, content_type, book_uuid).Step() == SQLITE_DONE;
 }
 
 // --- Cloud Sync Specific ---
 bool DatabaseManager::UpdateBookSyncStatus(const std::string& book_uuid, const std::string& sync_status, const std::string& google_drive_file_id) {
     if (!db_) return false;
-    const char* sql = "UPDATE books SET sync_status = ?, google_drive_file_id = ? WHERE uuid = ?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) return false;
-    sqlite3_bind_text(stmt, 1, sync_status.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, google_drive_file_id.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, book_uuid.c_str(), -1, SQLITE_STATIC);
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    QueueWrite("UpdateBookSyncStatus", book_uuid, [this, book_uuid, sync_status, google_drive_file_id] {
+        CachedStatement stmt(Prepare("UPDATE books SET sync_status = ?, google_drive_file_id = ? WHERE uuid = ?;", "UpdateBookSyncStatus"));
+        return stmt && stmt.Bind(sync_status, google_drive_file_id, book_uuid).Step() == SQLITE_DONE;
+    }, [sync_status, google_drive_file_id](Book& book) {
+        book.sync_status = sync_status;
+        book.google_drive_file_id = google_drive_file_id;
+    });
+    return true;
 }
 
+// Queued like the status updates above, so the two kinds of change land in the order made.
 bool DatabaseManager::UpdateBookFields(const std::string& book_uuid, const std::string& new_path, const std::string& new_hash) {
     if (!db_) return false;
-    const char* sql = "UPDATE books SET path = ?, hash = ?, sync_status = 'synced' WHERE uuid = ?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) return false;
-    sqlite3_bind_text(stmt, 1, new_path.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, new_hash.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, book_uuid.c_str(), -1, SQLITE_STATIC);
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    QueueWrite("UpdateBookFields", book_uuid, [this, book_uuid, new_path, new_hash] {
+        CachedStatement stmt(Prepare("UPDATE books SET path = ?, hash = ?, sync_status = 'synced' WHERE uuid = ?;", "UpdateBookFields"));
+        return stmt && stmt.Bind(new_path, new_hash, book_uuid).Step() == SQLITE_DONE;
+    }, [new_path, new_hash](Book& book) {
+        book.path = new_path;
+        book.hash = new_hash;
+        book.sync_status = "synced";
+    });
+    return true;
 }
 
 bool DatabaseManager::UpdateBookToCloudOnly(const std::string& book_uuid) {
     if (!db_) return false;
-    const char* sql = "UPDATE books SET path = '', hash = '', sync_status = 'cloud' WHERE uuid = ?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) return false;
-    sqlite3_bind_text(stmt, 1, book_uuid.c_str(), -1, SQLITE_STATIC);
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    QueueWrite("UpdateBookToCloudOnly", book_uuid, [this, book_uuid] {
+        CachedStatement stmt(Prepare("UPDATE books SET path = '', hash = '', sync_status = 'cloud' WHERE uuid = ?;", "UpdateBookToCloudOnly"));
+        return stmt && stmt.Bind(book_uuid).Step() == SQLITE_DONE;
+    }, [](Book& book) {
+        book.path.clear();
+        book.hash.clear();
+        book.sync_status = "cloud";
+    });
+    return true;
 }
 
 bool DatabaseManager::UpdateBookToLocalOnly(const std::string& book_uuid) {
     if (!db_) return false;
-    const char* sql = "UPDATE books SET google_drive_file_id = '', sync_status = 'local' WHERE uuid = ?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) return false;
-    sqlite3_bind_text(stmt, 1, book_uuid.c_str(), -1, SQLITE_STATIC);
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    QueueWrite("UpdateBookToLocalOnly", book_uuid, [this, book_uuid] {
+        CachedStatement stmt(Prepare("UPDATE books SET google_drive_file_id = '', sync_status = 'local' WHERE uuid = ?;", "UpdateBookToLocalOnly"));
+        return stmt && stmt.Bind(book_uuid).Step() == SQLITE_DONE;
+    }, [](Book& book) {
+        book.google_drive_file_id.clear();
+        book.sync_status = "local";
+    });
+    return true;
+}
+
+std::vector<std::string> DatabaseManager::GetBookUuidsNeedingTextIndex() {
+    auto lock = Lock();
+    std::vector<std::string> uuids;
+    if (!db_ || !text_search_available_) return uuids;
+
+    CachedStatement stmt(Prepare(R"(
+        SELECT b.uuid FROM books b
+        LEFT JOIN book_text_state s ON s.book_uuid = b.uuid
+        WHERE b.path IS NOT NULL AND b.path != '' AND b.hash IS NOT NULL AND b.hash != ''
+          AND (s.book_uuid IS NULL OR s.hash IS NOT b.hash OR s.complete = 0)
+        ORDER BY b.last_read_time DESC;
+    )", "GetBookUuidsNeedingTextIndex"));
+    if (!stmt) return uuids;
+    while (stmt.Step() == SQLITE_ROW) {
+        uuids.push_back(column_text(stmt.get(), 0));
+    }
+    return uuids;
+}
+
+int DatabaseManager::BeginTextIndex(const std::string& uuid, const std::string& hash) {
+    auto lock = Lock();
+    if (!db_ || !text_search_available_) return -1;
+
+    {
+        CachedStatement stmt(Prepare("SELECT hash, indexed_chapters FROM book_text_state WHERE book_uuid = ?;", "BeginTextIndex"));
+        if (!stmt) return -1;
+        if (stmt.Bind(uuid).Step() == SQLITE_ROW && column_text(stmt.get(), 0) == hash) {
+            return sqlite3_column_int(stmt.get(), 1);
+        }
+    }
+
+    // New book, or its file changed: drop whatever was indexed for the old contents.
+    if (!exec_sql(db_, "BEGIN;", "BeginTextIndex: Failed to begin transaction")) return -1;
+    CachedStatement delete_text(Prepare("DELETE FROM book_text WHERE book_uuid = ?;", "BeginTextIndex"));
+    bool success = delete_text && delete_text.Bind(uuid).Step() == SQLITE_DONE;
+    bool book_exists = true;
+    if (success) {
+        // Only for a book still in the library; DeleteBook has already cleared a removed one.
+        CachedStatement reset_state(Prepare("INSERT OR REPLACE INTO book_text_state (book_uuid, hash, indexed_chapters, complete) "
+                                            "SELECT ?, ?, 0, 0 WHERE EXISTS (SELECT 1 FROM books WHERE uuid = ?);", "BeginTextIndex"));
+        success = reset_state && reset_state.Bind(uuid, hash, uuid).Step() == SQLITE_DONE;
+        book_exists = sqlite3_changes(db_) > 0;
+    }
+    if (!success || !book_exists) {
+        if (!success) {
+            DebugLogger::log("BeginTextIndex: Failed to reset index for " + uuid + ": " + std::string(sqlite3_errmsg(db_)));
+        }
+        exec_sql(db_, "ROLLBACK;", "BeginTextIndex: Failed to roll back");
+        return -1;
+    }
+    return exec_sql(db_, "COMMIT;", "BeginTextIndex: Failed to commit") ? 0 : -1;
+}
+
+bool DatabaseManager::AddTextIndexChapter(const std::string& uuid, int chapter_index, const std::vector<std::string>& paragraphs) {
+    auto lock = Lock();
+    if (!db_ || !text_search_available_) return false;
+    if (!exec_sql(db_, "BEGIN;", "AddTextIndexChapter: Failed to begin transaction")) return false;
+
+    // The state row goes with the book in DeleteBook. Without it the book was deleted while
+    // being indexed, and its rows would only be orphans in search results.
+    CachedStatement update(Prepare("UPDATE book_text_state SET indexed_chapters = ? WHERE book_uuid = ?;", "AddTextIndexChapter"));
+    bool success = update && update.Bind(chapter_index + 1, uuid).Step() == SQLITE_DONE;
+    if (success && sqlite3_changes(db_) == 0) {
+        DebugLogger::log("AddTextIndexChapter: " + uuid + " was removed from the library; not indexing it.");
+        exec_sql(db_, "ROLLBACK;", "AddTextIndexChapter: Failed to roll back");
+        return false;
+    }
+    if (success) {
+        CachedStatement insert(Prepare("INSERT INTO book_text (content, book_uuid, chapter, paragraph) VALUES (?, ?, ?, ?);", "AddTextIndexChapter"));
+        success = static_cast<bool>(insert);
+        for (size_t i = 0; i < paragraphs.size() && success; ++i) {
+            if (paragraphs[i].empty()) continue;
+            success = insert.Bind(paragraphs[i], uuid, chapter_index, static_cast<int>(i)).Step() == SQLITE_DONE;
+            insert.Reset();
+        }
+    }
+
+    if (!success) {
+        DebugLogger::log("AddTextIndexChapter: Failed for " + uuid + " chapter " + std::to_string(chapter_index) + ": " + std::string(sqlite3_errmsg(db_)));
+        exec_sql(db_, "ROLLBACK;", "AddTextIndexChapter: Failed to roll back");
+        return false;
+    }
+    return exec_sql(db_, "COMMIT;", "AddTextIndexChapter: Failed to commit");
+}
+
+bool DatabaseManager::FinishTextIndex(const std::string& uuid) {
+    auto lock = Lock();
+    if (!db_ || !text_search_available_) return false;
+    CachedStatement stmt(Prepare("UPDATE book_text_state SET complete = 1 WHERE book_uuid = ?;", "FinishTextIndex"));
+    return stmt && stmt.Bind(uuid).Step() == SQLITE_DONE;
+}
+
+std::vector<TextSearchHit> DatabaseManager::SearchBookText(const std::string& query, int limit) {
+    auto lock = Lock();
+    std::vector<TextSearchHit> hits;
+    if (!db_ || !text_search_available_) return hits;
+    std::string fts_query = to_fts_query(query);
+    if (fts_query.empty()) return hits;
+
+    // Rows left over from a file's previous contents are skipped until it is re-indexed.
+    CachedStatement stmt(Prepare(R"(
+        SELECT book_text.book_uuid, b.title, snippet(book_text, 0, '[', ']', '...', 16), book_text.chapter, book_text.paragraph
+        FROM book_text
+        JOIN books b ON b.uuid = book_text.book_uuid
+        JOIN book_text_state s ON s.book_uuid = book_text.book_uuid AND s.hash = b.hash
+        WHERE book_text MATCH ?
+        ORDER BY book_text.rank
+        LIMIT ?;
+    )", "SearchBookText"));
+    if (!stmt) return hits;
+    stmt.Bind(fts_query, limit);
+    while (stmt.Step() == SQLITE_ROW) {
+        TextSearchHit hit;
+        hit.book_uuid = column_text(stmt.get(), 0);
+        hit.title = column_text(stmt.get(), 1);
+        hit.snippet = column_text(stmt.get(), 2);
+        hit.position.chapter_index = sqlite3_column_int(stmt.get(), 3);
+        hit.position.paragraph_index = sqlite3_column_int(stmt.get(), 4);
+        hits.push_back(std::move(hit));
+    }
+    return hits;
 }
 
 std::string DatabaseManager::GetDatabasePath() const {
@@ -459,23 +1036,10 @@ std::string DatabaseManager::GetDatabasePath() const {
 }
 
 void DatabaseManager::InitializeSystemSettings(const std::string& base_path) {
+    auto lock = Lock();
     if (!db_) return;
 
-    // 1. Create systemInfo table
-    const char* create_sql = R"(
-        CREATE TABLE IF NOT EXISTS systemInfo (
-            key TEXT PRIMARY KEY NOT NULL,
-            value TEXT NOT NULL
-        );
-    )";
-    char* err_msg = nullptr;
-    if (sqlite3_exec(db_, create_sql, 0, 0, &err_msg) != SQLITE_OK) {
-        DebugLogger::log("Failed to create systemInfo table: " + std::string(err_msg));
-        sqlite3_free(err_msg);
-        return;
-    }
-
-    // 2. Check if table is empty (first time setup)
+    // 1. Check if table is empty (first time setup); the table itself is created by the schema migrations
     const char* check_sql = "SELECT COUNT(*) FROM systemInfo;";
     sqlite3_stmt* stmt;
     int count = 0;
@@ -486,7 +1050,7 @@ void DatabaseManager::InitializeSystemSettings(const std::string& base_path) {
     }
     sqlite3_finalize(stmt);
 
-    // 3. If empty, populate with default values
+    // 2. If empty, populate with default values
     if (count == 0) {
         DebugLogger::log("Populating systemInfo table with default settings...");
         
@@ -516,44 +1080,29 @@ void DatabaseManager::InitializeSystemSettings(const std::string& base_path) {
 }
 
 std::map<std::string, std::string> DatabaseManager::GetAllSettings() const {
+    auto lock = Lock();
     std::map<std::string, std::string> settings;
     if (!db_) return settings;
 
-    const char* sql = "SELECT key, value FROM systemInfo;";
-    sqlite3_stmt* stmt;
-
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) {
-        DebugLogger::log("GetAllSettings: Failed to prepare statement: " + std::string(sqlite3_errmsg(db_)));
-        return settings;
-    }
+    CachedStatement stmt(Prepare("SELECT key, value FROM systemInfo;", "GetAllSettings"));
+    if (!stmt) return settings;
 
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        std::string key = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        std::string value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        settings[key] = value;
+    while (stmt.Step() == SQLITE_ROW) {
+        settings[column_text(stmt.get(), 0)] = column_text(stmt.get(), 1);
     }
-
-    sqlite3_finalize(stmt);
     return settings;
 }
 
 bool DatabaseManager::SetSetting(const std::string& key, const std::string& value) {
+    auto lock = Lock();
     if (!db_) return false;
-    const char* sql = "INSERT OR REPLACE INTO systemInfo (key, value) VALUES (?, ?);";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) {
-        DebugLogger::log("SetSetting: Failed to prepare statement: " + std::string(sqlite3_errmsg(db_)));
-        return false;
-    }
-    sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, value.c_str(), -1, SQLITE_TRANSIENT);
-    
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
+    CachedStatement stmt(Prepare("INSERT OR REPLACE INTO systemInfo (key, value) VALUES (?, ?);", "SetSetting"));
+    if (!stmt) return false;
+
+    bool success = stmt.Bind(key, value).Step() == SQLITE_DONE;
     if (!success) {
         DebugLogger::log("SetSetting: Failed to execute statement for key '" + key + "': " + std::string(sqlite3_errmsg(db_)));
     }
-    
-    sqlite3_finalize(stmt);
     return success;
 }
 
@@ -561,86 +1110,48 @@ bool DatabaseManager::SetSetting(const std::string& key, const std::string& valu
 // --- Multi-Device Sync Methods ---
 
 std::map<std::string, Book> DatabaseManager::GetAllBooksByDriveId() const {
+    auto lock = Lock();
     std::map<std::string, Book> books;
     if (!db_) return books;
 
-    const char* sql = "SELECT uuid, title, author, path, hash, current_page, total_pages, last_read_time, add_date, cover_image_path, format, pdf_content_type, pdf_health_status, ocr_status, sync_status, google_drive_file_id FROM books WHERE google_drive_file_id IS NOT NULL AND google_drive_file_id != '' ORDER BY last_read_time DESC;";
-    sqlite3_stmt* stmt;
+    CachedStatement stmt(Prepare("SELECT " BOOK_COLUMNS " FROM books WHERE google_drive_file_id IS NOT NULL AND google_drive_file_id != '' ORDER BY last_read_time DESC;",
+                                 "GetAllBooksByDriveId"));
+    if (!stmt) return books;
 
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, 0) != SQLITE_OK) {
-        DebugLogger::log("GetAllBooksByDriveId: Failed to prepare statement: " + std::string(sqlite3_errmsg(db_)));
-        return books;
-    }
-
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Book book;
-        book.uuid = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        book.title = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        book.author = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        book.path = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        book.hash = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-        book.current_page = sqlite3_column_int(stmt, 5);
-        book.total_pages = sqlite3_column_int(stmt, 6);
-        book.last_read_time = sqlite3_column_int64(stmt, 7);
-        book.add_date = sqlite3_column_int64(stmt, 8);
-        const char* cover = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9));
-        book.cover_image_path = cover ? cover : "";
-        const char* format = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 10));
-        book.format = format ? format : "";
-        const char* content_type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 11));
-        book.pdf_content_type = content_type ? content_type : "unknown";
-        const char* health_status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 12));
-        book.pdf_health_status = health_status ? health_status : "unchecked";
-        const char* ocr_status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 13));
-        book.ocr_status = ocr_status ? ocr_status : "none";
-        const char* sync_status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 14));
-        book.sync_status = sync_status ? sync_status : "local";
-        const char* gdrive_id = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 15));
-        book.google_drive_file_id = gdrive_id ? gdrive_id : "";
+    while (stmt.Step() == SQLITE_ROW) {
+        Book book = ReadCurrentBookRow(stmt.get());
         
         if (!book.google_drive_file_id.empty()) {
             books[book.google_drive_file_id] = book;
         }
     }
-
-    sqlite3_finalize(stmt);
     return books;
 }
 
 void DatabaseManager::AddOrUpdateBookFromCloud(const Book& cloud_book) {
+    auto lock = Lock();
     if (!db_ || cloud_book.google_drive_file_id.empty()) {
         return;
     }
 
-    // Check if a book with this google_drive_file_id already exists
-    const char* check_sql = "SELECT uuid, last_read_time FROM books WHERE google_drive_file_id = ?;";
-    sqlite3_stmt* check_stmt;
+    // Check if a book with this google_drive_file_id already exists. Its last-read time
+    // includes queued progress, so a newer local read is not overwritten.
     std::string existing_uuid;
     time_t existing_last_read_time = 0;
-
-    if (sqlite3_prepare_v2(db_, check_sql, -1, &check_stmt, 0) == SQLITE_OK) {
-        sqlite3_bind_text(check_stmt, 1, cloud_book.google_drive_file_id.c_str(), -1, SQLITE_STATIC);
-        if (sqlite3_step(check_stmt) == SQLITE_ROW) {
-            existing_uuid = reinterpret_cast<const char*>(sqlite3_column_text(check_stmt, 0));
-            existing_last_read_time = sqlite3_column_int64(check_stmt, 1);
+    {
+        CachedStatement check(Prepare("SELECT " BOOK_COLUMNS " FROM books WHERE google_drive_file_id = ?;", "AddOrUpdateBookFromCloud"));
+        if (check && check.Bind(cloud_book.google_drive_file_id).Step() == SQLITE_ROW) {
+            Book existing = ReadCurrentBookRow(check.get());
+            existing_uuid = existing.uuid;
+            existing_last_read_time = existing.last_read_time;
         }
     }
-    sqlite3_finalize(check_stmt);
 
     if (!existing_uuid.empty()) {
         // Book exists, update it only if the cloud version is newer
-        if (cloud_book.last_read_time > existing_last_read_time) {
-            const char* update_sql = "UPDATE books SET current_page = ?, last_read_time = ? WHERE uuid = ?;";
-            sqlite3_stmt* update_stmt;
-            if (sqlite3_prepare_v2(db_, update_sql, -1, &update_stmt, 0) == SQLITE_OK) {
-                sqlite3_bind_int(update_stmt, 1, cloud_book.current_page);
-                sqlite3_bind_int64(update_stmt, 2, cloud_book.last_read_time);
-                sqlite3_bind_text(update_stmt, 3, existing_uuid.c_str(), -1, SQLITE_STATIC);
-                if (sqlite3_step(update_stmt) != SQLITE_DONE) {
-                    DebugLogger::log("AddOrUpdateBookFromCloud: Failed to update progress for UUID " + existing_uuid);
-                }
-                sqlite3_finalize(update_stmt);
-            }
+        if (cloud_book.last_read_time > existing_last_read_time &&
+            !UpdateProgressAndTimestamp(existing_uuid, cloud_book.current_page, cloud_book.last_read_time)) {
+            DebugLogger::log("AddOrUpdateBookFromCloud: Failed to update progress for UUID " + existing_uuid);
         }
     } else {
         // Book does not exist, insert a new record
@@ -651,4 +1162,3 @@ void DatabaseManager::AddOrUpdateBookFromCloud(const Book& cloud_book) {
         AddBook(new_book);
     }
 }
-
@@ -4,24 +4,80 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <functional>
 #include <map>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include "Book.h"
+#include "SystemUtils.h"
 
 struct sqlite3; // Forward declaration
+struct sqlite3_stmt;
+
+// Orders the library view offers. Each has an index on (key, uuid), so a page is read
+// straight off the index however large the table is.
+enum class LibrarySortKey {
+    Recent,  // Last read first
+    Title,   // A-Z, ignoring case
+    Author,  // A-Z, ignoring case
+    AddDate  // Newest first
+};
+constexpr int kLibrarySortKeyCount = 4;
+
+// Keyset position: the sort key and UUID of the last row of a page.
+struct LibraryCursor {
+    time_t time_key = 0;   // Recent and AddDate
+    std::string text_key;  // Title and Author
+    std::string uuid;
+
+    // The position just past book in the given order.
+    static LibraryCursor After(const Book& book, LibrarySortKey sort_key);
+};
+
+// What happened to the books table after some point in its change sequence.
+struct LibraryChanges {
+    int64_t sequence = 0;              // Where this delta ends; pass it as the next since
+    int book_count = 0;
+    std::vector<Book> changed;         // Added or updated rows, oldest change first
+    std::vector<std::string> deleted;  // UUIDs of removed rows
+    bool needs_text_index = false;     // A changed row is new or its file is not the one indexed
+};
+
+// One passage matched by a library-wide full-text search.
+struct TextSearchHit {
+    std::string book_uuid;
+    std::string title;
+    std::string snippet; // Matched terms are wrapped in [ ]
+    ReadingPosition position;
+};
 
 class DatabaseManager {
 public:
     explicit DatabaseManager(const std::string& db_path);
     ~DatabaseManager();
 
+    // Creates or upgrades the schema. False if it could not be brought up to date, in which
+    // case the rest of the interface must not be used.
     bool InitDatabase();
     bool AddBook(const Book& book);
+    // Inserts books in a single transaction. Returns, per book, whether its row was written.
+    std::vector<bool> AddBooks(const std::vector<Book>& books);
     bool BookExists(const std::string& hash);
     std::vector<Book> GetAllBooks();
+    int GetBookCount();
+    // One page of the library in the given order. Pass nullptr for the first page; after
+    // must come from the same order.
+    std::vector<Book> GetBooksPage(const LibraryCursor* after, int limit, LibrarySortKey sort_key = LibrarySortKey::Recent);
+    // Fallback for jumping to a page whose cursor is not known yet.
+    std::vector<Book> GetBooksPageAtOffset(int offset, int limit, LibrarySortKey sort_key = LibrarySortKey::Recent);
     std::optional<Book> GetBookByUUID(const std::string& uuid);
     std::optional<Book> GetBookByHash(const std::string& hash);
     bool UpdateProgress(const std::string& book_uuid, int current_page);
     bool UpdateProgressAndTimestamp(const std::string& uuid, int current_page, time_t last_read_time);
+    bool UpdateProgressAndPosition(const std::string& uuid, int current_page, const ReadingPosition& position, time_t last_read_time);
     bool UpdateLastReadTime(const std::string& uuid);
     bool DeleteBook(const std::string& book_uuid);
     bool UpdateOcrStatus(const std::string& book_uuid, const std::string& status);
@@ -33,19 +89,96 @@ public:
     bool UpdateBookToLocalOnly(const std::string& uuid);
     bool UpdateBookFields(const std::string& uuid, const std::string& new_path, const std::string& new_hash);
 
+    // Progress, last-read, path and sync-status updates are queued and written in batches
+    // by a background thread, so callers never wait on the disk or the connection. They
+    // return true once queued: a write that later fails is only logged. Until a write lands,
+    // every Book read back has it applied, but queries that filter or order by the updated
+    // columns see the old values. on_applied is called from the writer thread after each
+    // batch, so callers can refresh what they derived from those queries.
+    void SetWritesAppliedCallback(std::function<void()> on_applied);
+
     std::string GetDatabasePath() const;
     void InitializeSystemSettings(const std::string& base_path);
     std::map<std::string, std::string> GetAllSettings() const;
     bool SetSetting(const std::string& key, const std::string& value);
 
+    // Position of the library's change counter, which every write to a book advances.
+    int64_t GetLibraryChangeSequence();
+    // Books added, changed or deleted after since, a value from GetLibraryChangeSequence or
+    // an earlier result's sequence.
+    LibraryChanges GetLibraryChangesSince(int64_t since);
+
+    // --- File fingerprints ---
+    // SHA-256 of the file at path. While the file's device, inode, size and mtime match the
+    // ones recorded with its last hash, and a hash of a few sampled blocks still agrees, the
+    // recorded hash is returned without reading the whole file. Empty if it cannot be read.
+    std::string GetFileHash(const std::string& path);
+    // Records sha256 as the hash of the file at path, e.g. a copy of a file just hashed.
+    void RecordFileHash(const std::string& path, const std::string& sha256);
+
+    // --- Library-wide full-text index (FTS5) ---
+    bool IsTextSearchAvailable() const { return text_search_available_; }
+    // Books whose text has not been indexed for their current hash, or whose indexing was interrupted.
+    std::vector<std::string> GetBookUuidsNeedingTextIndex();
+    // Starts or resumes indexing a book and returns the first chapter still to index. A changed
+    // hash discards the old rows and starts over at chapter 0. -1 if the book is gone or on error.
+    int BeginTextIndex(const std::string& uuid, const std::string& hash);
+    // Stores one chapter's paragraphs and records it as done, in a single transaction. False,
+    // writing nothing, if the book has been deleted since BeginTextIndex.
+    bool AddTextIndexChapter(const std::string& uuid, int chapter_index, const std::vector<std::string>& paragraphs);
+    bool FinishTextIndex(const std::string& uuid);
+    std::vector<TextSearchHit> SearchBookText(const std::string& query, int limit);
+
     // --- Multi-Device Sync Methods ---
     std::map<std::string, Book> GetAllBooksByDriveId() const;
     void AddOrUpdateBookFromCloud(const Book& cloud_book);
 
 private:
-    void UpgradeSchema();
+    // Returns the statement for sql, compiling it on first use; nullptr (logged under
+    // caller) if it does not compile. Wrap it in a CachedStatement for the call and never
+    // hold the same statement twice at once. Call with mutex_ held.
+    sqlite3_stmt* Prepare(const char* sql, const char* caller) const;
+    // Locks the connection. Queued writes are left to the writer thread.
+    std::unique_lock<std::recursive_mutex> Lock() const;
+    // Queues apply to run on the writer thread; patch makes the same change to a Book read
+    // before then. kind and uuid identify the update: a newer one with the same pair replaces it.
+    void QueueWrite(const char* kind, const std::string& uuid, std::function<bool()> apply,
+                    std::function<void(Book&)> patch);
+    // Runs every queued write in one transaction. Only the writer thread and the destructor
+    // call this, with mutex_ held.
+    void ApplyPendingWrites() const;
+    // ReadBookRow with the queued writes for the row applied.
+    Book ReadCurrentBookRow(sqlite3_stmt* stmt) const;
+    void WriterLoop();
+    // Writes one books row. Call with mutex_ held.
+    bool InsertBook(const Book& book);
+    // Brings the schema up to the current version; see kMigrations. Call with mutex_ held.
+    bool MigrateSchema();
+    // Upserts the file_fingerprints row for path. stat must be taken before either hash.
+    void StoreFileFingerprint(const std::string& path, const SystemUtils::FileStat& stat,
+                              const std::string& sample_hash, const std::string& sha256);
+    bool text_search_available_ = false;
     std::string db_path_;
     sqlite3* db_ = nullptr;
+    // Serializes use of the shared connection and its cached statements across threads.
+    // Recursive because some methods are built from others.
+    mutable std::recursive_mutex mutex_;
+    mutable std::unordered_map<std::string, sqlite3_stmt*> statement_cache_; // Keyed by SQL text
+
+    // Write-behind queue. pending_mutex_ is only ever held briefly, so queueing an update
+    // never waits for mutex_ or the disk.
+    struct PendingWrite {
+        std::string key;
+        std::string uuid;
+        std::function<bool()> apply;
+        std::function<void(Book&)> patch;
+    };
+    mutable std::mutex pending_mutex_;
+    std::condition_variable pending_cv_;
+    mutable std::vector<PendingWrite> pending_writes_;
+    bool stop_writer_ = false;
+    std::function<void()> on_writes_applied_;
+    std::thread writer_thread_;
 };
 
 #endif // DATABASE_MANAGER_H
\ No newline at end of file
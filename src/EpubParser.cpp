@@ -41,6 +41,7 @@ struct EpubParser::Impl {
     std::string title = "Unknown Title";
     std::string author = "Unknown Author";
     fs::path opf_dir;
+    CancellationToken cancel;
 
     std::vector<BookChapter> chapters;
     std::map<std::string, std::string> manifest;
@@ -77,6 +78,7 @@ struct EpubParser::Impl {
         if (!nav_point_element) return current_level_chapters;
 
         for (auto* current_point = nav_point_element; current_point; current_point = current_point->NextSiblingElement("navPoint")) {
+            if (cancel.IsCancelled()) break;
             auto* nav_label = current_point->FirstChildElement("navLabel");
             auto* content = current_point->FirstChildElement("content");
 
@@ -173,6 +175,7 @@ struct EpubParser::Impl {
             // Fallback: build chapters from spine if no NCX is found
             if (spine_el) {
                 for (auto* itemref = spine_el->FirstChildElement("itemref"); itemref; itemref = itemref->NextSiblingElement("itemref")) {
+                    if (cancel.IsCancelled()) break;
                     const char* idref = itemref->Attribute("idref");
                     if (idref && manifest.count(idref)) {
                         BookChapter chapter;
@@ -188,8 +191,9 @@ struct EpubParser::Impl {
     }
 };
 
-EpubParser::EpubParser(const std::string& file_path) : pimpl_(std::make_unique<Impl>()) {
+EpubParser::EpubParser(const std::string& file_path, const CancellationToken& cancel) : pimpl_(std::make_unique<Impl>()) {
     pimpl_->file_path = file_path;
+    pimpl_->cancel = cancel;
     DebugLogger::init("debug.log");
     DebugLogger::log("--- Starting EPUB Parse for: " + file_path + " ---");
     int error = 0;
@@ -2,6 +2,7 @@
 #ifndef EPUB_PARSER_H
 #define EPUB_PARSER_H
 
+#include "CancellationToken.h"
 #include "IBookParser.h"
 #include <string>
 #include <vector>
@@ -9,7 +10,8 @@
 
 class EpubParser : public IBookParser {
 public:
-    EpubParser(const std::string& file_path);
+    // Parsing stops early, leaving a partial book, if cancel is triggered.
+    EpubParser(const std::string& file_path, const CancellationToken& cancel = CancellationToken());
     ~EpubParser() override;
 
     bool isOpen() const;
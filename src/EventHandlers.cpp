@@ -2,9 +2,12 @@
 #include "BookViewModel.h"
 #include "DebugLogger.h"
 #include "PdfParser.h"
+#include "PerfStats.h"
 #include "SystemUtils.h"
 #include "UIComponents.h"
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <memory>
 #include <thread>
@@ -12,6 +15,11 @@
 
 namespace fs = std::filesystem;
 
+namespace {
+// Passages listed by the library-wide search, best match first.
+constexpr int kMaxGlobalSearchHits = 200;
+}
+
 EventHandlers::EventHandlers(AppState& state, 
                            ScreenInteractive& screen,
                            std::mutex& ui_mutex,
@@ -19,11 +27,12 @@ EventHandlers::EventHandlers(AppState& state,
                            LibraryManager& library_manager,
                            SyncController& sync_controller,
                            GoogleAuthManager& auth_manager,
-                           ConfigManager& config_manager)
+                           ConfigManager& config_manager,
+                           TaskExecutor& executor)
     : app_state_(state), screen_(screen), ui_state_mutex_(ui_mutex),
       db_manager_(db_manager), library_manager_(library_manager),
       sync_controller_(sync_controller), auth_manager_(auth_manager),
-      config_manager_(config_manager) {}
+      config_manager_(config_manager), executor_(executor) {}
 
 void EventHandlers::SetUIComponents(UIComponents* ui_components) {
     ui_components_ = ui_components;
@@ -34,6 +43,17 @@ bool EventHandlers::HandleEvent(Event event, Component modal_component, std::fun
         return modal_component->OnEvent(event);
     }
 
+    // Text prompts take every key before the global shortcuts see it
+    if (app_state_.current_view == View::Library && app_state_.library_search_active) {
+        return HandleLibrarySearchEvents(event, refresh_books);
+    }
+    if (app_state_.current_view == View::GlobalSearch) {
+        return HandleGlobalSearchEvents(event, refresh_books);
+    }
+    if (app_state_.current_view == View::Reader && (app_state_.goto_prompt_active || app_state_.search_prompt_active)) {
+        return HandleReaderEvents(event, refresh_books);
+    }
+
     // Handle global events first
     if (HandleGlobalEvents(event, refresh_books)) {
         return true;
@@ -53,25 +73,16 @@ bool EventHandlers::HandleEvent(Event event, Component modal_component, std::fun
             return HandleDeleteConfirmEvents(event, refresh_books);
         case View::SystemInfo:
             return HandleSystemInfoEvents(event);
+        case View::Loading:
+            return HandleLoadingEvents(event);
+        case View::Import:
+            return HandleImportEvents(event);
         default:
             return false;
     }
 }
 
 bool EventHandlers::HandleGlobalEvents(Event event, std::function<void()> refresh_books) {
-    if (event == BOOK_LOAD_SUCCESS) {
-        app_state_.current_view = View::Reader;
-        screen_.Post(Event::Custom);
-        return true;
-    }
-    
-    if (event == BOOK_LOAD_FAILURE) {
-        app_state_.message_to_show = "Failed to load book. The file may be corrupt or unsupported.";
-        app_state_.current_view = View::ShowMessage;
-        screen_.Post(Event::Custom);
-        return true;
-    }
-
     if (event == Event::Character('q')) {
         // Only handle 'q' globally if we're NOT in Reader view
         if (app_state_.current_view != View::Reader) {
@@ -83,6 +94,12 @@ bool EventHandlers::HandleGlobalEvents(Event event, std::function<void()> refres
         return false;
     }
 
+    if (event == Event::Character('P')) {
+        app_state_.perf_overlay_enabled = !app_state_.perf_overlay_enabled;
+        app_state_.changes.MarkDirty();
+        return true;
+    }
+
     if (event == Event::Character('c')) {
         std::lock_guard<std::mutex> lock(ui_state_mutex_);
         if (app_state_.cloud_sync_enabled) {
@@ -115,7 +132,191 @@ bool EventHandlers::HandleGlobalEvents(Event event, std::function<void()> refres
     return false;
 }
 
+void EventHandlers::OpenBook(const Book& selected_book, std::function<void()> refresh_books, ReadingPosition open_at) {
+    auto final_load_action = [&, open_at](Book book_to_load) {
+        if (open_at.IsValid()) {
+            book_to_load.position = open_at;
+        }
+        db_manager_.UpdateLastReadTime(book_to_load.uuid);
+        app_state_.current_book = book_to_load;
+        
+        auto start_loading = [&](const Book& book_to_load_inner) {
+            // A load already running is left to notice its token and stop on its own; whatever
+            // it still publishes is dropped by the same check, so there is nothing to wait for.
+            app_state_.load_token.Cancel();
+            app_state_.load_task.Cancel();
+            app_state_.load_token = CancellationToken();
+            app_state_.book_load_in_progress = true;
+            app_state_.loading_message = "Loading: " + book_to_load_inner.title;
+            app_state_.search_query.clear();
+            app_state_.search_hits.clear();
+            app_state_.search_hit_index = -1;
+            app_state_.current_view = View::Loading;
+            app_state_.changes.MarkDirty();
+            
+            app_state_.load_task = executor_.Submit(TaskPriority::UiCritical, [&, book_path = book_to_load_inner.path, book_current_page = book_to_load_inner.current_page, book_position = book_to_load_inner.position, dual_page = app_state_.dual_page_mode_enabled, cancel = app_state_.load_token] {
+                // A cancelled load just stops; whoever cancelled it has already moved the UI on.
+                // Every outcome is published with the cancel check applied on the UI thread, so a
+                // load abandoned late can never switch the view for the book opened after it.
+                auto fail = [this, cancel] {
+                    app_state_.Publish([cancel](AppState& state) {
+                        if (cancel.IsCancelled()) return;
+                        state.book_load_in_progress = false;
+                        state.message_to_show = "Failed to load book. The file may be corrupt or unsupported.";
+                        state.current_view = View::ShowMessage;
+                    });
+                };
+                auto parser = CreateParser(book_path, cancel);
+                if (cancel.IsCancelled()) {
+                    return;
+                }
+                if (!parser) {
+                    fail();
+                    return;
+                }
+
+                if (auto* pdf_parser = dynamic_cast<PdfParser*>(parser.get())) {
+                    if (!pdf_parser->Load()) {
+                        fail();
+                        return;
+                    }
+                    if (pdf_parser->IsImageBased()) {
+                        app_state_.Publish([cancel](AppState& state) {
+                            if (cancel.IsCancelled()) return;
+                            state.book_load_in_progress = false;
+                            state.message_to_show = "This PDF appears to be image-based. OCR functionality is under development.";
+                            state.current_view = View::ShowMessage;
+                        });
+                        return;
+                    }
+                }
+                
+                // A PDF's layout is just its page count, and a legacy page-only bookmark needs pages
+                // to resolve. Anything else opens straight onto the saved chapter, wrapped on its
+                // own, while the renderer has the full layout built in the background.
+                // The page size is the renderer's, so the layout built here is the one it keeps.
+                bool layout_now = dynamic_cast<PdfParser*>(parser.get()) != nullptr || !book_position.IsValid();
+                int screen_width = screen_.dimx();
+                int page_width = dual_page && screen_width > 100 ? (screen_width / 2) - 4 : screen_width - 4;
+                int page_height = screen_.dimy() - 6;
+                std::unique_ptr<BookViewModel> temp_model = std::make_unique<BookViewModel>(std::move(parser), executor_);
+                if (layout_now && !temp_model->Paginate(page_width, page_height, cancel)) {
+                    return;
+                }
+                if (cancel.IsCancelled()) {
+                    return;
+                }
+                // Hits for an active query keep streaming in while the index is built; they are
+                // refreshed here rather than while drawing, so a frame never changes state.
+                temp_model->StartSearchIndex([this, model = temp_model.get()] {
+                    app_state_.Publish([model](AppState& state) {
+                        if (state.book_view_model.get() != model || state.search_query.empty()) return;
+                        state.search_hits = model->Search(state.search_query);
+                        if (state.search_hit_index >= static_cast<int>(state.search_hits.size())) {
+                            state.search_hit_index = -1;
+                        }
+                    });
+                });
+
+                // The model is installed on the UI thread, so the renderer never sees it half set up.
+                // An Esc that lands before then leaves it to be destroyed with the update.
+                auto model = std::make_shared<std::unique_ptr<BookViewModel>>(std::move(temp_model));
+                app_state_.Publish([model, cancel, layout_now, page_width, page_height, book_position, book_current_page](AppState& state) {
+                    if (cancel.IsCancelled()) return;
+                    state.book_view_model = std::move(*model);
+                    if (book_position.IsValid()) {
+                        state.current_position = book_position;
+                        // Without a layout yet there is no page to resolve; keep the stored one until
+                        // the renderer adopts the background layout.
+                        state.current_page = layout_now ? state.book_view_model->GetPageForPosition(book_position)
+                                                        : book_current_page;
+                    } else {
+                        // Legacy record with a page index only; anchor a position to it from now on.
+                        state.current_page = book_current_page;
+                        state.current_position = state.book_view_model->GetPositionForPage(book_current_page);
+                    }
+                    state.paginated = layout_now;
+                    if (layout_now) {
+                        state.last_page_width = page_width;
+                        state.last_page_height = page_height;
+                    }
+                    state.book_load_in_progress = false;
+                    state.current_view = View::Reader;
+                });
+            });
+        };
+
+        if (book_to_load.format == "PDF" && book_to_load.pdf_content_type == "image_based") {
+            app_state_.book_to_action_uuid = book_to_load.uuid;
+            app_state_.current_view = View::ConfirmOcr;
+            app_state_.changes.MarkDirty();
+        } else {
+            start_loading(book_to_load);
+        }
+    };
+
+    if (app_state_.cloud_sync_enabled && selected_book.sync_status == "cloud") {
+        app_state_.current_view = View::Loading;
+        app_state_.loading_message = "Verifying and downloading " + selected_book.title + "...";
+        app_state_.changes.MarkDirty();
+
+        // Get config directory for downloads from the single source of truth
+        fs::path download_dir = config_manager_.GetLibraryPath();
+        
+        sync_controller_.verify_and_download_book_async(selected_book, download_dir.string(), [this, refresh_books](bool success, std::string msg){
+            if (success) {
+                screen_.Post([this, refresh_books]{
+                    refresh_books();
+                    app_state_.current_view = View::Library;
+                    app_state_.changes.MarkDirty();
+                });
+            } else {
+                app_state_.Publish([msg](AppState& state) {
+                    state.message_to_show = msg;
+                    state.current_view = View::ShowMessage;
+                });
+            }
+        });
+    } else if (app_state_.cloud_sync_enabled && selected_book.sync_status == "synced") {
+        app_state_.current_view = View::Loading;
+        app_state_.loading_message = "Checking for latest progress...";
+        app_state_.changes.MarkDirty();
+
+        sync_controller_.get_latest_progress_async(selected_book.uuid, [this, final_load_action](Book updated_book, bool success){
+            if (success) {
+                screen_.Post([final_load_action, updated_book]{
+                    final_load_action(updated_book);
+                });
+            } else {
+                screen_.Post([final_load_action, updated_book]{
+                    final_load_action(updated_book); // Use local version on failure
+                });
+            }
+        });
+    } else {
+        final_load_action(selected_book);
+    }
+}
+
 bool EventHandlers::HandleLibraryEvents(Event event, std::function<void()> refresh_books) {
+    if (event == Event::Character('/')) {
+        app_state_.library_search_active = true;
+        app_state_.library_search_input.clear();
+        app_state_.changes.MarkDirty();
+        return true;
+    }
+
+    if (event == Event::Character('o')) {
+        auto& library = *app_state_.library_model;
+        auto next = static_cast<LibrarySortKey>((static_cast<int>(library.GetSortKey()) + 1) % kLibrarySortKeyCount);
+        library.SetSortKey(next);
+        config_manager_.SetLibrarySortKey(next);
+        app_state_.library_current_page = 0;
+        app_state_.selected_book_index = 0;
+        app_state_.changes.MarkDirty();
+        return true;
+    }
+
     if (event == Event::Character('s')) {
         app_state_.system_info_data.clear();
         
@@ -147,6 +348,16 @@ bool EventHandlers::HandleLibraryEvents(Event event, std::function<void()> refre
         app_state_.system_info_data.push_back({"Last Picker Path", config_manager_.GetLastPickerPath().string()});
         app_state_.system_info_data.push_back({"Cloud Sync Enabled", app_state_.cloud_sync_enabled ? "Yes" : "No"});
 
+        // Rolling latency percentiles, for diagnosing lag reports
+        app_state_.system_info_data.push_back({"", ""}); // Separator
+        app_state_.system_info_data.push_back({"Performance", "p50 / p95 / p99 ms"});
+        char perf_buf[64];
+        for (const auto& summary : PerfStats::GetSummaries()) {
+            std::snprintf(perf_buf, sizeof(perf_buf), "%.1f / %.1f / %.1f (%zu samples)", summary.p50_ms, summary.p95_ms, summary.p99_ms, summary.samples);
+            app_state_.system_info_data.push_back({"  " + summary.stage, summary.samples == 0 ? "-" : perf_buf});
+        }
+        app_state_.system_info_data.push_back({"  Redraws/s", std::to_string(PerfStats::GetFramesPerSecond())});
+
         app_state_.system_info_data.push_back({"", ""}); // Separator
         app_state_.system_info_data.push_back({"Cli Ebook Reader", "Version 1.0"});
         app_state_.system_info_data.push_back({"License", "MIT"});
@@ -157,140 +368,55 @@ bool EventHandlers::HandleLibraryEvents(Event event, std::function<void()> refre
     }
 
 
+    if (event == Event::Character('f')) {
+        app_state_.global_search_input.clear();
+        app_state_.global_search_hits.clear();
+        app_state_.selected_global_search_hit = 0;
+        app_state_.current_view = View::GlobalSearch;
+        if (app_state_.text_indexer) app_state_.text_indexer->RequestScan();
+        app_state_.changes.MarkDirty();
+        return true;
+    }
+
     if (event == Event::Character('r') && app_state_.cloud_sync_enabled) {
         app_state_.sync_status = SyncStatus::IN_PROGRESS;
         app_state_.sync_message = "Syncing with cloud...";
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
 
-        std::thread([this, refresh_books] {
+        executor_.Submit(TaskPriority::Background, [this, refresh_books] {
             sync_controller_.full_sync([this, refresh_books](bool success, std::string msg) {
-                app_state_.sync_status = success ? SyncStatus::SUCCESS : SyncStatus::ERROR;
-                app_state_.sync_message = msg;
+                app_state_.Publish([success, msg](AppState& state) {
+                    state.sync_status = success ? SyncStatus::SUCCESS : SyncStatus::ERROR;
+                    state.sync_message = msg;
+                });
                 screen_.Post([refresh_books] {
                     refresh_books();
                 });
             });
-        }).detach();
+        });
         return true;
     }
 
     if (event == Event::Return) {
-        if (app_state_.books.empty()) return true;
-        int global_index = (app_state_.library_current_page * app_state_.library_entries_per_page) + app_state_.selected_book_index;
-        if (global_index >= app_state_.books.size()) return true;
+        const Book* selected = app_state_.library_model->GetBook(app_state_.SelectedLibraryRow());
+        if (!selected) return true;
 
-        const auto& selected_book = app_state_.books[global_index];
-        
-        auto final_load_action = [&](Book book_to_load) {
-            db_manager_.UpdateLastReadTime(book_to_load.uuid);
-            
-            auto start_loading = [&](const Book& book_to_load_inner) {
-                if (app_state_.load_thread.joinable()) app_state_.load_thread.join();
-                app_state_.loading_message = "Loading: " + book_to_load_inner.title;
-                app_state_.current_view = View::Loading;
-                screen_.Post(Event::Custom);
-                
-                app_state_.load_thread = std::thread([&, book_path = book_to_load_inner.path, book_current_page = book_to_load_inner.current_page] {
-                    auto parser = CreateParser(book_path);
-                    if (!parser) {
-                        screen_.PostEvent(BOOK_LOAD_FAILURE);
-                        return;
-                    }
-
-                    if (auto* pdf_parser = dynamic_cast<PdfParser*>(parser.get())) {
-                        if (!pdf_parser->Load()) {
-                            screen_.PostEvent(BOOK_LOAD_FAILURE);
-                            return;
-                        }
-                        if (pdf_parser->IsImageBased()) {
-                            app_state_.message_to_show = "This PDF appears to be image-based. OCR functionality is under development.";
-                            app_state_.current_view = View::ShowMessage;
-                            screen_.Post(Event::Custom);
-                            return;
-                        }
-                    }
-                    
-                    std::unique_ptr<BookViewModel> temp_model = std::make_unique<BookViewModel>(std::move(parser));
-                    temp_model->Paginate(screen_.dimx() - 4, screen_.dimy() - 6);
-
-                    {
-                        std::lock_guard<std::mutex> lock(app_state_.model_mutex);
-                        app_state_.book_view_model = std::move(temp_model);
-                        app_state_.current_page = book_current_page;
-                        app_state_.paginated = true;
-                    }
-                    
-                    screen_.PostEvent(BOOK_LOAD_SUCCESS);
-                });
-            };
-
-            if (book_to_load.format == "PDF" && book_to_load.pdf_content_type == "image_based") {
-                app_state_.book_to_action_uuid = book_to_load.uuid;
-                app_state_.current_view = View::ConfirmOcr;
-                screen_.Post(Event::Custom);
-            } else {
-                start_loading(book_to_load);
-            }
-        };
-
-        if (app_state_.cloud_sync_enabled && selected_book.sync_status == "cloud") {
-            app_state_.current_view = View::Loading;
-            app_state_.loading_message = "Verifying and downloading " + selected_book.title + "...";
-            screen_.Post(Event::Custom);
-
-            // Get config directory for downloads from the single source of truth
-            fs::path download_dir = config_manager_.GetLibraryPath();
-            
-            sync_controller_.verify_and_download_book_async(selected_book, download_dir.string(), [this, refresh_books](bool success, std::string msg){
-                if (success) {
-                    screen_.Post([this, refresh_books]{
-                        refresh_books();
-                        app_state_.current_view = View::Library;
-                        screen_.Post(Event::Custom);
-                    });
-                } else {
-                    app_state_.message_to_show = msg;
-                    app_state_.current_view = View::ShowMessage;
-                    screen_.Post(Event::Custom);
-                }
-            });
-        } else if (app_state_.cloud_sync_enabled && selected_book.sync_status == "synced") {
-            app_state_.current_view = View::Loading;
-            app_state_.loading_message = "Checking for latest progress...";
-            screen_.Post(Event::Custom);
-
-            std::thread([this, book_uuid = selected_book.uuid, final_load_action]{
-                sync_controller_.get_latest_progress_async(book_uuid, [this, final_load_action](Book updated_book, bool success){
-                    if (success) {
-                        screen_.Post([final_load_action, updated_book]{
-                            final_load_action(updated_book);
-                        });
-                    } else {
-                        screen_.Post([final_load_action, updated_book]{
-                            final_load_action(updated_book); // Use local version on failure
-                        });
-                    }
-                });
-            }).detach();
-        } else {
-            final_load_action(selected_book);
-        }
+        OpenBook(*selected, refresh_books);
         return true;
     }
 
     if (event == Event::Character('a')) {
         UpdatePickerEntries(app_state_.current_picker_path, app_state_.picker_entries, app_state_.selected_picker_entry);
         app_state_.current_view = View::FilePicker;
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
         return true;
     }
 
     if (event == Event::Character('d')) {
-        if (app_state_.books.empty()) return true;
-        int global_index = (app_state_.library_current_page * app_state_.library_entries_per_page) + app_state_.selected_book_index;
-        if (global_index >= app_state_.books.size()) return true;
+        const Book* selected = app_state_.library_model->GetBook(app_state_.SelectedLibraryRow());
+        if (!selected) return true;
         
-        const auto& book = app_state_.books[global_index];
+        const Book book = *selected;
         
         app_state_.uuid_to_delete = book.uuid;
         app_state_.title_to_delete = book.title;
@@ -313,7 +439,7 @@ bool EventHandlers::HandleLibraryEvents(Event event, std::function<void()> refre
         app_state_.selected_delete_option = 0;
         
         app_state_.current_view = View::DeleteConfirm;
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
         return true;
     }
 
@@ -322,7 +448,7 @@ bool EventHandlers::HandleLibraryEvents(Event event, std::function<void()> refre
             app_state_.library_current_page--;
             app_state_.selected_book_index = 0;
         }
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
         return true;
     }
     
@@ -331,31 +457,31 @@ bool EventHandlers::HandleLibraryEvents(Event event, std::function<void()> refre
             app_state_.library_current_page++;
             app_state_.selected_book_index = 0;
         }
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
         return true;
     }
 
     if (event == Event::Character('u')) {
-        if (app_state_.cloud_sync_enabled && !app_state_.books.empty()) {
-            int global_index = app_state_.library_current_page * app_state_.library_entries_per_page + app_state_.selected_book_index;
-            if (global_index < app_state_.books.size()) {
-                const auto& book = app_state_.books[global_index];
+        if (app_state_.cloud_sync_enabled) {
+            if (const Book* selected = app_state_.library_model->GetBook(app_state_.SelectedLibraryRow())) {
+                const Book book = *selected;
                 if (book.sync_status == "local") {
                     app_state_.sync_status = SyncStatus::IN_PROGRESS;
                     app_state_.sync_message = "Uploading " + book.title + "...";
-                    screen_.Post(Event::Custom);
-                    std::thread([this, book_uuid = book.uuid, refresh_books] {
+                    app_state_.changes.MarkDirty();
+                    executor_.Submit(TaskPriority::Io, [this, book_uuid = book.uuid, refresh_books] {
                         sync_controller_.upload_book(book_uuid, [this, refresh_books](bool success, std::string msg){
-                            app_state_.sync_status = success ? SyncStatus::SUCCESS : SyncStatus::ERROR;
-                            app_state_.sync_message = msg;
+                            app_state_.Publish([success, msg](AppState& state) {
+                                state.sync_status = success ? SyncStatus::SUCCESS : SyncStatus::ERROR;
+                                state.sync_message = msg;
+                            });
                             if (success) {
                                 screen_.Post([refresh_books]{
                                     refresh_books();
                                 });
                             }
-                            screen_.Post(Event::Custom);
                         });
-                    }).detach();
+                    });
                 }
             }
         }
@@ -366,23 +492,94 @@ bool EventHandlers::HandleLibraryEvents(Event event, std::function<void()> refre
 }
 
 bool EventHandlers::HandleReaderEvents(Event event, std::function<void()> refresh_books) {
+    if (app_state_.goto_prompt_active) {
+        if (event == Event::Return) {
+            JumpTo(app_state_.goto_input);
+            app_state_.goto_prompt_active = false;
+        } else if (event == Event::Escape) {
+            app_state_.goto_prompt_active = false;
+        } else if (event == Event::Backspace) {
+            if (!app_state_.goto_input.empty()) app_state_.goto_input.pop_back();
+        } else if (event.is_character() && event.character().find_first_not_of("0123456789.%") == std::string::npos) {
+            app_state_.goto_input += event.character();
+        }
+        app_state_.changes.MarkDirty();
+        return true; // The prompt swallows every key while open
+    }
+
+    if (app_state_.search_prompt_active) {
+        if (event == Event::Return) {
+            app_state_.search_prompt_active = false;
+            app_state_.search_query = app_state_.search_input;
+            app_state_.search_hit_index = -1;
+            GoToSearchHit(true);
+        } else if (event == Event::Escape) {
+            app_state_.search_prompt_active = false;
+        } else if (event == Event::Backspace) {
+            std::string& input = app_state_.search_input;
+            while (!input.empty() && (static_cast<unsigned char>(input.back()) & 0xC0) == 0x80) {
+                input.pop_back();
+            }
+            if (!input.empty()) input.pop_back();
+        } else if (event.is_character()) {
+            app_state_.search_input += event.character();
+        }
+        app_state_.changes.MarkDirty();
+        return true;
+    }
+
+    if (QueueNavigation(event)) {
+        return true;
+    }
+    // Wake-ups carry no input; queued turns wait for the frame, which applies them once.
+    if (event == Event::Custom) {
+        return false;
+    }
+    // Any other key acts on the position the queued turns lead to.
+    ApplyPendingNavigation();
+
+    if (event == Event::Character('/')) {
+        app_state_.search_prompt_active = true;
+        app_state_.search_input = app_state_.search_query;
+        app_state_.changes.MarkDirty();
+        return true;
+    }
+
+    if ((event == Event::Character('n') || event == Event::Character('N')) && !app_state_.search_query.empty()) {
+        GoToSearchHit(event == Event::Character('n'));
+        app_state_.changes.MarkDirty();
+        return true;
+    }
+
+    if (event == Event::Character('g')) {
+        app_state_.goto_prompt_active = true;
+        app_state_.goto_input.clear();
+        app_state_.changes.MarkDirty();
+        return true;
+    }
+
     if (event == Event::Character('d')) {
         app_state_.dual_page_mode_enabled = !app_state_.dual_page_mode_enabled;
         app_state_.paginated = false; // Force re-pagination on next render
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
         return true;
     }
 
     if (event == Event::Character('q')) {
-        int global_index = (app_state_.library_current_page * app_state_.library_entries_per_page) + app_state_.selected_book_index;
-        if (global_index < app_state_.books.size()) {
-            Book book_to_update = app_state_.books[global_index];
-            book_to_update.current_page = app_state_.current_page;
+        if (!app_state_.current_book.uuid.empty()) {
+            Book& book_to_update = app_state_.current_book;
+            // Until a layout is adopted current_page is only the stored page carried over; the
+            // position is what was actually read.
+            bool has_layout = app_state_.book_view_model && app_state_.book_view_model->GetTotalPages() > 0;
+            if (has_layout) {
+                book_to_update.current_page = app_state_.current_page;
+            }
+            book_to_update.position = app_state_.current_position;
             book_to_update.last_read_time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
             
-            db_manager_.UpdateProgressAndTimestamp(book_to_update.uuid, book_to_update.current_page, book_to_update.last_read_time);
+            db_manager_.UpdateProgressAndPosition(book_to_update.uuid, book_to_update.current_page, book_to_update.position, book_to_update.last_read_time);
 
-            if (app_state_.cloud_sync_enabled && (book_to_update.sync_status == "synced" || book_to_update.sync_status == "cloud")) {
+            if (has_layout && app_state_.cloud_sync_enabled && (book_to_update.sync_status == "synced" || book_to_update.sync_status == "cloud")) {
                 sync_controller_.upload_progress_async(book_to_update, [](bool success){
                     if (!success) {
                         DebugLogger::log("Background progress upload failed.");
@@ -393,50 +590,39 @@ bool EventHandlers::HandleReaderEvents(Event event, std::function<void()> refres
         
         refresh_books();
         app_state_.current_view = View::Library;
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
         return true;
     }
 
-    if (event == Event::ArrowRight || event == Event::Character('j')) {
+    if (event == Event::Character('s')) {
         if (app_state_.book_view_model) {
-            bool is_dual = app_state_.dual_page_mode_enabled && (screen_.dimx() > 100);
-            int increment = is_dual ? 2 : 1;
-            if (app_state_.current_page + increment < app_state_.book_view_model->GetTotalPages()) {
-                app_state_.current_page += increment;
-            } else if (app_state_.current_page < app_state_.book_view_model->GetTotalPages() - 1) {
-                app_state_.current_page = app_state_.book_view_model->GetTotalPages() - 1;
+            app_state_.scroll_mode_enabled = !app_state_.scroll_mode_enabled;
+            if (!app_state_.current_position.IsValid()) {
+                AnchorReadingPosition();
+            }
+            if (!app_state_.scroll_mode_enabled) {
+                app_state_.current_page = app_state_.book_view_model->GetPageForPosition(app_state_.current_position);
             }
         }
-        screen_.Post(Event::Custom);
-        return true;
-    }
-    
-    if (event == Event::ArrowLeft || event == Event::Character('k')) {
-        bool is_dual = app_state_.dual_page_mode_enabled && (screen_.dimx() > 100);
-        int decrement = is_dual ? 2 : 1;
-        app_state_.current_page -= decrement;
-        if (app_state_.current_page < 0) app_state_.current_page = 0;
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
         return true;
     }
 
     if (event == Event::Character('m')) {
-        app_state_.toc_entries.clear();
-        FlattenChapters(app_state_.book_view_model->GetChapters(), app_state_.toc_entries);
-        
-        app_state_.toc_entries_per_page = screen_.dimy() - 8;
-        if (app_state_.toc_entries_per_page <= 0) app_state_.toc_entries_per_page = 1;
-        
-        app_state_.toc_total_pages = app_state_.toc_entries.empty() ? 1 : (app_state_.toc_entries.size() + app_state_.toc_entries_per_page - 1) / app_state_.toc_entries_per_page;
-        app_state_.toc_current_page = 0;
-        
-        int start_index = 0;
-        int end_index = std::min((int)app_state_.toc_entries.size(), app_state_.toc_entries_per_page);
-        app_state_.toc_visible_entries.assign(app_state_.toc_entries.begin() + start_index, app_state_.toc_entries.begin() + end_index);
-        
-        app_state_.selected_toc_entry = 0;
+        if (!app_state_.book_view_model) return true;
+        auto& model = *app_state_.book_view_model;
+        const auto& toc = model.GetTocEntries();
+
+        // Open on the entry for the chapter being read
+        int chapter = model.GetChapterIndexForPage(app_state_.current_page);
+        if (app_state_.scroll_mode_enabled || chapter < 0) {
+            chapter = app_state_.current_position.chapter_index;
+        }
+        auto it = std::upper_bound(toc.begin(), toc.end(), chapter, [](int c, const TocEntry& entry) { return c < entry.chapter_index; });
+        app_state_.selected_toc_entry = it == toc.begin() ? 0 : static_cast<int>(std::distance(toc.begin(), it)) - 1;
+        app_state_.toc_scroll_top = app_state_.selected_toc_entry - app_state_.toc_visible_rows / 2;
         app_state_.current_view = View::TableOfContents;
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
         return true;
     }
 
@@ -444,48 +630,56 @@ bool EventHandlers::HandleReaderEvents(Event event, std::function<void()> refres
 }
 
 bool EventHandlers::HandleTableOfContentsEvents(Event event) {
+    if (!app_state_.book_view_model) {
+        app_state_.current_view = View::Reader;
+        return true;
+    }
+    const auto& toc = app_state_.book_view_model->GetTocEntries();
+    int& selected = app_state_.selected_toc_entry;
+
     if (event == Event::Return) {
-        int global_toc_index = (app_state_.toc_current_page * app_state_.toc_entries_per_page) + app_state_.selected_toc_entry;
-        if (app_state_.book_view_model && global_toc_index < app_state_.toc_entries.size()) {
-            app_state_.current_page = app_state_.book_view_model->GetChapterStartPage(global_toc_index);
+        if (selected >= 0 && selected < static_cast<int>(toc.size())) {
+            int chapter_index = toc[selected].chapter_index;
+            if (app_state_.scroll_mode_enabled || app_state_.book_view_model->GetTotalPages() == 0) {
+                app_state_.current_position = {chapter_index, 0, 0};
+                app_state_.current_page = app_state_.book_view_model->GetPageForPosition(app_state_.current_position);
+            } else {
+                app_state_.current_page = app_state_.book_view_model->GetChapterStartPage(chapter_index);
+                AnchorReadingPosition();
+            }
         }
         app_state_.current_view = View::Reader;
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
         return true;
     }
     
     if (event == Event::Escape || event == Event::Character('m')) {
         app_state_.current_view = View::Reader;
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
         return true;
     }
 
-    auto update_visible_toc = [&]() {
-        int start_index = app_state_.toc_current_page * app_state_.toc_entries_per_page;
-        int end_index = std::min(start_index + app_state_.toc_entries_per_page, (int)app_state_.toc_entries.size());
-        app_state_.toc_visible_entries.assign(app_state_.toc_entries.begin() + start_index, app_state_.toc_entries.begin() + end_index);
-        app_state_.selected_toc_entry = 0;
-    };
-    
-    if (event == Event::ArrowLeft) {
-        if (app_state_.toc_current_page > 0) {
-            app_state_.toc_current_page--;
-            update_visible_toc();
-        }
-        screen_.Post(Event::Custom);
-        return true;
-    }
-    
-    if (event == Event::ArrowRight) {
-        if (app_state_.toc_current_page < app_state_.toc_total_pages - 1) {
-            app_state_.toc_current_page++;
-            update_visible_toc();
-        }
-        screen_.Post(Event::Custom);
-        return true;
+    int rows = std::max(1, app_state_.toc_visible_rows);
+    int last = std::max(0, (int)toc.size() - 1);
+    if (event == Event::ArrowDown) {
+        selected = std::min(selected + 1, last);
+    } else if (event == Event::ArrowUp) {
+        selected = std::max(selected - 1, 0);
+    } else if (event == Event::ArrowRight || event == Event::PageDown) {
+        selected = std::min(selected + rows, last);
+        app_state_.toc_scroll_top += rows;
+    } else if (event == Event::ArrowLeft || event == Event::PageUp) {
+        selected = std::max(selected - rows, 0);
+        app_state_.toc_scroll_top -= rows;
+    } else if (event == Event::Home) {
+        selected = 0;
+    } else if (event == Event::End) {
+        selected = last;
+    } else {
+        return false;
     }
-
-    return false;
+    app_state_.changes.MarkDirty();
+    return true;
 }
 
 bool EventHandlers::HandleFilePickerEvents(Event event, std::function<void()> refresh_books) {
@@ -509,17 +703,32 @@ bool EventHandlers::HandleFilePickerEvents(Event event, std::function<void()> re
             config_manager_.SetLastPickerPath(new_path.parent_path());
             
             // Add the book to library
-            app_state_.message_to_show = library_manager_.AddBook(new_path.string(), db_manager_, screen_.dimx(), screen_.dimy());
+            app_state_.message_to_show = library_manager_.AddBook(new_path.string(), db_manager_, executor_, screen_.dimx(), screen_.dimy());
             refresh_books();
             app_state_.current_view = View::ShowMessage;
         }
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
+        return true;
+    }
+    
+    if (event == Event::Character('i')) {
+        // The highlighted folder, or the one being browsed when a file or "../" is highlighted
+        fs::path folder = app_state_.current_picker_path;
+        if (!app_state_.picker_entries.empty()) {
+            const std::string& selected_item = app_state_.picker_entries[app_state_.selected_picker_entry];
+            std::error_code ec;
+            if (selected_item != "../" && fs::is_directory(folder / selected_item, ec)) {
+                folder /= selected_item;
+            }
+        }
+        config_manager_.SetLastPickerPath(app_state_.current_picker_path);
+        StartImport(folder, refresh_books);
         return true;
     }
     
     if (event == Event::Escape) {
         app_state_.current_view = View::Library;
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
         return true;
     }
 
@@ -533,7 +742,7 @@ bool EventHandlers::HandleFilePickerEvents(Event event, std::function<void()> re
 bool EventHandlers::HandleDeleteConfirmEvents(Event event, std::function<void()> refresh_books) {
     if (event == Event::Escape) {
         app_state_.current_view = View::Library;
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
         return true;
     }
     
@@ -543,15 +752,15 @@ bool EventHandlers::HandleDeleteConfirmEvents(Event event, std::function<void()>
 
         if (selected_option == "Cancel") {
             app_state_.current_view = View::Library;
-            screen_.Post(Event::Custom);
+            app_state_.changes.MarkDirty();
             return true;
         }
 
         app_state_.current_view = View::Loading;
         app_state_.loading_message = "Processing: " + selected_option;
-        screen_.Post(Event::Custom);
+        app_state_.changes.MarkDirty();
 
-        std::thread([this, selected_option, uuid, refresh_books]{
+        executor_.Submit(TaskPriority::Io, [this, selected_option, uuid, refresh_books]{
             bool success = false;
             // --- Option Handling ---
             if (selected_option == "Delete from this device only") {
@@ -563,12 +772,13 @@ bool EventHandlers::HandleDeleteConfirmEvents(Event event, std::function<void()>
                         screen_.Post([this, refresh_books]{
                             refresh_books();
                             app_state_.current_view = View::Library;
-                            screen_.Post(Event::Custom);
+                            app_state_.changes.MarkDirty();
                         });
                     } else {
-                        app_state_.message_to_show = "Failed to delete from cloud.";
-                        app_state_.current_view = View::ShowMessage;
-                        screen_.Post(Event::Custom);
+                        app_state_.Publish([](AppState& state) {
+                            state.message_to_show = "Failed to delete from cloud.";
+                            state.current_view = View::ShowMessage;
+                        });
                     }
                 });
                 return; // Async, so we return here
@@ -582,7 +792,7 @@ bool EventHandlers::HandleDeleteConfirmEvents(Event event, std::function<void()>
                     screen_.Post([this, refresh_books]{
                         refresh_books();
                         app_state_.current_view = View::Library;
-                        screen_.Post(Event::Custom);
+                        app_state_.changes.MarkDirty();
                     });
                 });
                 return; // Async, so we return here
@@ -597,13 +807,14 @@ bool EventHandlers::HandleDeleteConfirmEvents(Event event, std::function<void()>
             // --- Post-Action Refresh for synchronous operations ---
             screen_.Post([this, refresh_books]{
                 refresh_books();
-                if (app_state_.selected_book_index >= app_state_.books.size()) {
-                    app_state_.selected_book_index = app_state_.books.empty() ? 0 : app_state_.books.size() - 1;
+                int book_count = app_state_.library_model->GetCount();
+                if (app_state_.SelectedLibraryRow() >= book_count) {
+                    app_state_.selected_book_index = std::max(0, book_count - 1 - app_state_.library_current_page * app_state_.library_entries_per_page);
                 }
                 app_state_.current_view = View::Library;
-                screen_.Post(Event::Custom);
+                app_state_.changes.MarkDirty();
             });
-        }).detach();
+        });
         return true;
     }
 
@@ -613,6 +824,223 @@ bool EventHandlers::HandleDeleteConfirmEvents(Event event, std::function<void()>
     return false;
 }
 
+bool EventHandlers::HandleLibrarySearchEvents(Event event, std::function<void()> refresh_books) {
+    if (event == Event::Return || event == Event::ArrowLeft || event == Event::ArrowRight) {
+        return HandleLibraryEvents(event, refresh_books);
+    }
+
+    std::string input = app_state_.library_search_input;
+    if (event == Event::Escape) {
+        app_state_.library_search_active = false;
+        input.clear();
+    } else if (event == Event::Backspace) {
+        // Drop a whole UTF-8 character, not just its last byte
+        while (!input.empty() && (static_cast<unsigned char>(input.back()) & 0xC0) == 0x80) {
+            input.pop_back();
+        }
+        if (!input.empty()) input.pop_back();
+    } else if (event.is_character()) {
+        input += event.character();
+    } else {
+        return false; // Up/Down and the like go to the menu
+    }
+
+    app_state_.library_search_input = input;
+    app_state_.library_model->SetSearchQuery(input);
+    app_state_.library_current_page = 0;
+    app_state_.selected_book_index = 0;
+    app_state_.last_library_width = 0; // Re-count pages for the new result set
+    app_state_.changes.MarkDirty();
+    return true;
+}
+
+bool EventHandlers::HandleGlobalSearchEvents(Event event, std::function<void()> refresh_books) {
+    auto& hits = app_state_.global_search_hits;
+    int& selected = app_state_.selected_global_search_hit;
+    if (event == Event::Escape) {
+        app_state_.current_view = View::Library;
+    } else if (event == Event::ArrowDown) {
+        selected = std::min(selected + 1, std::max(0, (int)hits.size() - 1));
+    } else if (event == Event::ArrowUp) {
+        selected = std::max(selected - 1, 0);
+    } else if (event == Event::Return) {
+        if (selected >= static_cast<int>(hits.size())) return true;
+        const TextSearchHit hit = hits[selected];
+        auto book = db_manager_.GetBookByUUID(hit.book_uuid);
+        if (!book) return true;
+        OpenBook(*book, refresh_books, hit.position);
+    } else {
+        std::string& input = app_state_.global_search_input;
+        if (event == Event::Backspace) {
+            while (!input.empty() && (static_cast<unsigned char>(input.back()) & 0xC0) == 0x80) {
+                input.pop_back();
+            }
+            if (!input.empty()) input.pop_back();
+        } else if (event.is_character()) {
+            input += event.character();
+        } else {
+            return true;
+        }
+        hits = db_manager_.SearchBookText(input, kMaxGlobalSearchHits);
+        selected = 0;
+    }
+    app_state_.changes.MarkDirty();
+    return true; // Every key goes to the search box while the view is open
+}
+
+bool EventHandlers::QueueNavigation(Event event) {
+    if (app_state_.scroll_mode_enabled) {
+        int screen_lines = std::max(1, screen_.dimy() - 6);
+        int delta = 0;
+        if (event == Event::ArrowDown || event == Event::Character('j')) delta = 1;
+        if (event == Event::ArrowUp || event == Event::Character('k')) delta = -1;
+        if (event == Event::ArrowRight || event == Event::PageDown || event == Event::Character(' ')) delta = screen_lines;
+        if (event == Event::ArrowLeft || event == Event::PageUp) delta = -screen_lines;
+        if (delta == 0) return false;
+        app_state_.pending_scroll_lines += delta;
+        return true;
+    }
+
+    if (event == Event::ArrowRight || event == Event::Character('j')) {
+        app_state_.pending_page_turns++;
+        return true;
+    }
+    if (event == Event::ArrowLeft || event == Event::Character('k')) {
+        app_state_.pending_page_turns--;
+        return true;
+    }
+    return false;
+}
+
+bool EventHandlers::ApplyPendingNavigation() {
+    int page_turns = app_state_.pending_page_turns;
+    int scroll_lines = app_state_.pending_scroll_lines;
+    app_state_.pending_page_turns = 0;
+    app_state_.pending_scroll_lines = 0;
+    if ((page_turns == 0 && scroll_lines == 0) || !app_state_.book_view_model) {
+        return false;
+    }
+
+    if (scroll_lines != 0) {
+        ScrollReader(scroll_lines);
+    }
+    if (page_turns != 0 && app_state_.book_view_model->GetTotalPages() == 0) {
+        // Still opening: turn by a screenful of lines until the page layout arrives.
+        ScrollReader(page_turns * std::max(1, screen_.dimy() - 6));
+    } else if (page_turns != 0) {
+        bool is_dual = app_state_.dual_page_mode_enabled && (screen_.dimx() > 100);
+        int step = is_dual ? 2 : 1;
+        int last_page = std::max(0, app_state_.book_view_model->GetTotalPages() - 1);
+        app_state_.current_page = std::clamp(app_state_.current_page + page_turns * step, 0, last_page);
+        AnchorReadingPosition();
+    }
+    return true;
+}
+
+bool EventHandlers::SyncReaderLayout() {
+    if (app_state_.current_view != View::Reader || !app_state_.book_view_model) {
+        return false;
+    }
+    bool is_dual = app_state_.dual_page_mode_enabled && (screen_.dimx() > 100);
+    int page_width = is_dual ? (screen_.dimx() / 2) - 4 : screen_.dimx() - 4;
+    int page_height = screen_.dimy() - 6;
+
+    // Re-layout runs in the background; keep showing the old layout until the new one is ready.
+    if (!app_state_.paginated || page_width != app_state_.last_page_width || page_height != app_state_.last_page_height) {
+        app_state_.book_view_model->RequestLayout(page_width, page_height, [this] { app_state_.changes.MarkDirty(); });
+        app_state_.paginated = true;
+        app_state_.last_page_width = page_width;
+        app_state_.last_page_height = page_height;
+    }
+    if (!app_state_.book_view_model->AdoptReadyLayout()) {
+        return false;
+    }
+    if (app_state_.current_position.IsValid()) {
+        app_state_.current_page = app_state_.book_view_model->GetPageForPosition(app_state_.current_position);
+    }
+    return true;
+}
+
+void EventHandlers::AnchorReadingPosition() {
+    // Before the first layout lands there are no pages, and the position is the only truth.
+    if (app_state_.book_view_model && app_state_.book_view_model->GetTotalPages() > 0) {
+        app_state_.current_position = app_state_.book_view_model->GetPositionForPage(app_state_.current_page);
+    }
+}
+
+void EventHandlers::ScrollReader(int delta_lines) {
+    if (!app_state_.book_view_model) {
+        return;
+    }
+    auto& model = *app_state_.book_view_model;
+    int line_width = screen_.dimx() - 4;
+    LineCursor top = model.GetLineForPosition(app_state_.current_position, line_width);
+    top = model.MoveLines(top, delta_lines, line_width);
+    app_state_.current_position = model.GetPositionForLine(top, line_width);
+    app_state_.current_page = model.GetPageForPosition(app_state_.current_position);
+}
+
+bool EventHandlers::JumpTo(const std::string& target) {
+    if (!app_state_.book_view_model || target.empty()) {
+        return false;
+    }
+    auto& model = *app_state_.book_view_model;
+    char* end = nullptr;
+    double value = std::strtod(target.c_str(), &end);
+    if (end == target.c_str()) {
+        return false;
+    }
+
+    if (*end == '%') {
+        // Percent jumps resolve through the offset index and never wait for a layout.
+        GoToPosition(model.GetPositionForFraction(value / 100.0));
+    } else {
+        int total_pages = model.GetTotalPages();
+        if (total_pages == 0) {
+            return false;
+        }
+        app_state_.current_page = std::clamp(static_cast<int>(value) - 1, 0, total_pages - 1);
+        AnchorReadingPosition();
+    }
+    DebugLogger::log("Reader: jumped to '" + target + "', page " + std::to_string(app_state_.current_page + 1));
+    return true;
+}
+
+void EventHandlers::GoToPosition(const ReadingPosition& position) {
+    auto& model = *app_state_.book_view_model;
+    app_state_.current_position = position;
+    if (app_state_.scroll_mode_enabled) {
+        int line_width = screen_.dimx() - 4;
+        app_state_.current_position = model.GetPositionForLine(model.GetLineForPosition(position, line_width), line_width);
+    }
+    app_state_.current_page = model.GetPageForPosition(app_state_.current_position);
+}
+
+void EventHandlers::GoToSearchHit(bool forward) {
+    if (!app_state_.book_view_model || app_state_.search_query.empty()) {
+        return;
+    }
+    // Re-read the hits: more of the book may have been indexed since the last jump.
+    auto& hits = app_state_.search_hits;
+    hits = app_state_.book_view_model->Search(app_state_.search_query);
+    if (hits.empty()) {
+        app_state_.search_hit_index = -1;
+        return;
+    }
+
+    int& index = app_state_.search_hit_index;
+    if (index < 0) {
+        // First jump: the first hit at or after the reading position, wrapping to the start.
+        auto it = std::lower_bound(hits.begin(), hits.end(), app_state_.current_position);
+        index = it == hits.end() ? 0 : static_cast<int>(it - hits.begin());
+    } else if (forward) {
+        index = (index + 1) % hits.size();
+    } else {
+        index = (index - 1 + static_cast<int>(hits.size())) % hits.size();
+    }
+    GoToPosition(hits[index]);
+}
+
 bool EventHandlers::HandleSystemInfoEvents(Event event) {
     if (event == Event::Escape) {
         app_state_.current_view = View::Library;
@@ -620,3 +1048,52 @@ bool EventHandlers::HandleSystemInfoEvents(Event event) {
     }
     return false;
 }
+
+bool EventHandlers::HandleLoadingEvents(Event event) {
+    // Only a book open can be abandoned; downloads and deletes run to completion.
+    if (event != Event::Escape || !app_state_.book_load_in_progress) {
+        return false;
+    }
+    // The load task notices between stages and exits; anything it had already published is
+    // dropped by its cancel check. It is waited for when the next book is opened or on shutdown.
+    app_state_.load_token.Cancel();
+    app_state_.book_load_in_progress = false;
+    app_state_.current_view = View::Library;
+    app_state_.changes.MarkDirty();
+    return true;
+}
+
+bool EventHandlers::HandleImportEvents(Event event) {
+    if (!app_state_.importer) {
+        return false;
+    }
+    if (!app_state_.importer->GetProgress().finished) {
+        if (event != Event::Escape) return false;
+        // Files already in flight finish and are kept; the view shows the totals when done.
+        app_state_.importer->Cancel();
+        app_state_.changes.MarkDirty();
+        return true;
+    }
+    if (event == Event::Return || event == Event::Escape) {
+        app_state_.importer.reset();
+        app_state_.current_view = View::Library;
+        app_state_.changes.MarkDirty();
+        return true;
+    }
+    return false;
+}
+
+void EventHandlers::StartImport(const fs::path& folder, std::function<void()> refresh_books) {
+    // Only one import at a time; the previous one has finished if the picker was reachable.
+    app_state_.importer.reset();
+    app_state_.importer = std::make_unique<LibraryImporter>(
+        db_manager_, library_manager_, executor_,
+        screen_.dimx() > 0 ? screen_.dimx() - 4 : 80, screen_.dimy() > 0 ? screen_.dimy() - 8 : 24,
+        [this] { app_state_.changes.MarkDirty(); },
+        [this, refresh_books] {
+            screen_.Post(refresh_books);
+        });
+    app_state_.importer->Start(folder);
+    app_state_.current_view = View::Import;
+    app_state_.changes.MarkDirty();
+}
@@ -7,6 +7,7 @@
 #include "GoogleAuthManager.h"
 #include "LibraryManager.h"
 #include "SyncController.h"
+#include "TaskExecutor.h"
 #include "UIUtils.h"
 #include "ftxui/component/component.hpp"
 #include "ftxui/component/screen_interactive.hpp"
@@ -27,23 +28,54 @@ public:
                   LibraryManager& library_manager,
                   SyncController& sync_controller,
                   GoogleAuthManager& auth_manager,
-                  ConfigManager& config_manager);
+                  ConfigManager& config_manager,
+                  TaskExecutor& executor);
 
     // Set UI components reference (called after UIComponents is created)
     void SetUIComponents(UIComponents* ui_components);
 
     // Main event handler
     bool HandleEvent(Event event, Component modal_component, std::function<void()> refresh_books);
+    // Applies reader navigation queued since the last frame. Called by the renderer at the
+    // start of each frame; returns true if the reading position moved.
+    bool ApplyPendingNavigation();
+    // Keeps the reader's layout in step with the screen: requests a background re-layout when
+    // the page size changes and adopts a finished one. Called by the renderer at the start of
+    // each frame, before ApplyPendingNavigation(); returns true if a new layout was adopted.
+    bool SyncReaderLayout();
     
 private:
     // Event handlers for different views
     bool HandleGlobalEvents(Event event, std::function<void()> refresh_books);
     bool HandleLibraryEvents(Event event, std::function<void()> refresh_books);
+    bool HandleLibrarySearchEvents(Event event, std::function<void()> refresh_books);
+    bool HandleGlobalSearchEvents(Event event, std::function<void()> refresh_books);
     bool HandleReaderEvents(Event event, std::function<void()> refresh_books);
     bool HandleTableOfContentsEvents(Event event);
     bool HandleFilePickerEvents(Event event, std::function<void()> refresh_books);
     bool HandleDeleteConfirmEvents(Event event, std::function<void()> refresh_books);
     bool HandleSystemInfoEvents(Event event);
+    bool HandleLoadingEvents(Event event);
+    bool HandleImportEvents(Event event);
+
+    // Imports every book under folder in the background and switches to the Import view.
+    void StartImport(const fs::path& folder, std::function<void()> refresh_books);
+    // Opens a book in the reader, downloading or syncing its progress first as needed. A valid
+    // open_at overrides the saved reading position.
+    void OpenBook(const Book& selected_book, std::function<void()> refresh_books, ReadingPosition open_at = {});
+    // Folds a reader navigation key into the pending page or line delta instead of moving at
+    // once, so a burst of key repeats handled before the next frame costs one page render.
+    bool QueueNavigation(Event event);
+    // Re-anchors the logical reading position to the start of the current page
+    void AnchorReadingPosition();
+    // Scroll mode: moves the reading position by delta lines and keeps current_page in step
+    void ScrollReader(int delta_lines);
+    // Jumps to a page number ("120") or a percentage of the book ("73%"); false if unparsable
+    bool JumpTo(const std::string& target);
+    // Moves the reader to a logical position, snapping to a line start in scroll mode
+    void GoToPosition(const ReadingPosition& position);
+    // Jumps to the next (or previous) search hit relative to the current position
+    void GoToSearchHit(bool forward);
     
     AppState& app_state_;
     ScreenInteractive& screen_;
@@ -53,6 +85,7 @@ private:
     SyncController& sync_controller_;
     GoogleAuthManager& auth_manager_;
     ConfigManager& config_manager_;
+    TaskExecutor& executor_;
     UIComponents* ui_components_ = nullptr;
 };
 
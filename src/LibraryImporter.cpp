@@ -0,0 +1,230 @@
+#include "LibraryImporter.h"
+#include "DebugLogger.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+// Files handed to the executor but not yet collected. Keeps the copies and parses from
+// racing ahead of the database writes and bounds the results held in memory.
+constexpr size_t kMaxInFlight = 64;
+// Rows written per transaction.
+constexpr size_t kImportBatchSize = 200;
+// Files found between progress notifications during the walk.
+constexpr size_t kScanProgressInterval = 100;
+
+bool is_supported_book(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".epub" || ext == ".txt" || ext == ".mobi" || ext == ".azw3" || ext == ".pdf";
+}
+}
+
+LibraryImporter::LibraryImporter(DatabaseManager& db_manager, LibraryManager& library_manager, TaskExecutor& executor,
+                                 int page_width, int page_height,
+                                 std::function<void()> on_progress, std::function<void()> on_finished)
+    : db_manager_(db_manager), library_manager_(library_manager), executor_(executor),
+      page_width_(page_width), page_height_(page_height),
+      on_progress_(std::move(on_progress)), on_finished_(std::move(on_finished)) {}
+
+LibraryImporter::~LibraryImporter() {
+    Cancel();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void LibraryImporter::Start(const fs::path& folder) {
+    if (thread_.joinable()) return;
+    folder_ = folder;
+    thread_ = std::thread(&LibraryImporter::Run, this);
+}
+
+void LibraryImporter::Cancel() {
+    cancel_.Cancel();
+}
+
+LibraryImporter::Progress LibraryImporter::GetProgress() const {
+    std::lock_guard<std::mutex> lock(progress_mutex_);
+    return progress_;
+}
+
+void LibraryImporter::NotifyProgress() {
+    if (on_progress_) on_progress_();
+}
+
+void LibraryImporter::Run() {
+    DebugLogger::log("[Import] Importing books from " + folder_.string());
+
+    std::vector<fs::path> files;
+    std::vector<Book> batch;
+    size_t next_file = 0;
+    size_t in_flight = 0;
+
+    // Hands queued files to the executor, up to kMaxInFlight at a time.
+    auto submit = [&] {
+        while (!cancel_.IsCancelled() && in_flight < kMaxInFlight && next_file < files.size()) {
+            fs::path path = files[next_file++];
+            in_flight++;
+            executor_.Submit(TaskPriority::Background, [this, path] {
+                FileResult result = ProcessFile(path);
+                // Notify under the lock: once the coordinator sees the last result it may
+                // finish and the importer be destroyed.
+                std::lock_guard<std::mutex> lock(results_mutex_);
+                results_.push_back(std::move(result));
+                results_cv_.notify_one();
+            });
+        }
+    };
+
+    // Takes finished files off the result queue, waiting for one if wait is set.
+    auto collect = [&](bool wait) {
+        std::deque<FileResult> ready;
+        {
+            std::unique_lock<std::mutex> lock(results_mutex_);
+            if (wait) {
+                results_cv_.wait(lock, [this] { return !results_.empty(); });
+            }
+            ready.swap(results_);
+        }
+        if (ready.empty()) return;
+
+        {
+            std::lock_guard<std::mutex> lock(progress_mutex_);
+            for (auto& result : ready) {
+                if (result.outcome == FileResult::Outcome::Skipped) continue;
+                progress_.processed++;
+                progress_.current_file = result.file_name;
+                switch (result.outcome) {
+                    case FileResult::Outcome::Added:     progress_.added++; break;
+                    case FileResult::Outcome::Duplicate: progress_.duplicates++; break;
+                    case FileResult::Outcome::Failed:    progress_.failed++; break;
+                    case FileResult::Outcome::Skipped:   break;
+                }
+            }
+        }
+        for (auto& result : ready) {
+            in_flight--;
+            if (result.book) {
+                batch.push_back(std::move(*result.book));
+            }
+        }
+        if (batch.size() >= kImportBatchSize) {
+            CommitBatch(batch);
+        }
+        NotifyProgress();
+    };
+
+    // Walk and process at the same time, so hashing starts with the first file found.
+    std::error_code ec;
+    std::error_code library_ec;
+    const fs::path library = fs::weakly_canonical(library_manager_.GetLibraryPath(), library_ec);
+    fs::recursive_directory_iterator it(folder_, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::recursive_directory_iterator() && !cancel_.IsCancelled(); it.increment(ec)) {
+        std::error_code entry_ec;
+        if (it->is_directory(entry_ec)) {
+            // Never import the library back into itself.
+            if (!library_ec && fs::weakly_canonical(it->path(), entry_ec) == library) {
+                it.disable_recursion_pending();
+            }
+            continue;
+        }
+        if (!it->is_regular_file(entry_ec) || !is_supported_book(it->path())) continue;
+
+        files.push_back(it->path());
+        if (files.size() % kScanProgressInterval == 0) {
+            {
+                std::lock_guard<std::mutex> lock(progress_mutex_);
+                progress_.found = static_cast<int>(files.size());
+            }
+            NotifyProgress();
+        }
+        submit();
+        collect(false);
+    }
+    if (ec) {
+        DebugLogger::log("[Import] Stopped walking " + folder_.string() + ": " + ec.message());
+    }
+    {
+        std::lock_guard<std::mutex> lock(progress_mutex_);
+        progress_.found = static_cast<int>(files.size());
+        progress_.scanning = false;
+    }
+    NotifyProgress();
+
+    // After a cancel only the files already handed out are waited for; they bail early.
+    while (in_flight > 0 || (!cancel_.IsCancelled() && next_file < files.size())) {
+        submit();
+        collect(true);
+    }
+    // Copied files are in the library either way, so they are recorded even if cancelled.
+    CommitBatch(batch);
+
+    Progress final_progress;
+    {
+        std::lock_guard<std::mutex> lock(progress_mutex_);
+        progress_.finished = true;
+        progress_.cancelled = cancel_.IsCancelled();
+        progress_.current_file.clear();
+        final_progress = progress_;
+    }
+    DebugLogger::log("[Import] " + std::string(final_progress.cancelled ? "Cancelled" : "Finished") +
+                     ": " + std::to_string(final_progress.added) + " added, " +
+                     std::to_string(final_progress.duplicates) + " duplicates, " +
+                     std::to_string(final_progress.failed) + " failed of " +
+                     std::to_string(final_progress.found) + " found.");
+    if (on_finished_) on_finished_();
+}
+
+LibraryImporter::FileResult LibraryImporter::ProcessFile(const fs::path& path) {
+    FileResult result;
+    result.file_name = path.filename().string();
+    if (cancel_.IsCancelled()) {
+        result.outcome = FileResult::Outcome::Skipped;
+        return result;
+    }
+
+    std::string hash = db_manager_.GetFileHash(path.string());
+    if (hash.empty()) {
+        DebugLogger::log("[Import] Could not hash " + path.string());
+        return result;
+    }
+    {
+        std::lock_guard<std::mutex> lock(claimed_mutex_);
+        if (!claimed_hashes_.insert(hash).second) {
+            result.outcome = FileResult::Outcome::Duplicate;
+            return result;
+        }
+    }
+    if (db_manager_.BookExists(hash)) {
+        result.outcome = FileResult::Outcome::Duplicate;
+        return result;
+    }
+
+    result.book = library_manager_.PrepareImport(path, hash, page_width_, page_height_, cancel_);
+    if (result.book) {
+        db_manager_.RecordFileHash(result.book->path, hash);
+        result.outcome = FileResult::Outcome::Added;
+    } else if (cancel_.IsCancelled()) {
+        result.outcome = FileResult::Outcome::Skipped;
+    }
+    return result;
+}
+
+void LibraryImporter::CommitBatch(std::vector<Book>& batch) {
+    if (batch.empty()) return;
+    std::vector<bool> written = db_manager_.AddBooks(batch);
+    int lost = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (written[i]) continue;
+        DebugLogger::log("[Import] Failed to record " + batch[i].path + "; removing the copy.");
+        std::error_code ec;
+        fs::remove(batch[i].path, ec);
+        lost++;
+    }
+    if (lost > 0) {
+        std::lock_guard<std::mutex> lock(progress_mutex_);
+        progress_.added -= lost;
+        progress_.failed += lost;
+    }
+    batch.clear();
+}
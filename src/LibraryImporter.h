@@ -0,0 +1,89 @@
+#ifndef LIBRARY_IMPORTER_H
+#define LIBRARY_IMPORTER_H
+
+#include "CancellationToken.h"
+#include "DatabaseManager.h"
+#include "LibraryManager.h"
+#include "TaskExecutor.h"
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+// Adds every supported book under a folder to the library. A coordinator thread walks the
+// tree and hands each file to the shared executor, where it is hashed, checked for a
+// duplicate, copied in and read for its metadata; the coordinator collects the results
+// and writes them to the database a batch at a time.
+class LibraryImporter {
+public:
+    struct Progress {
+        int found = 0;      // Supported files seen by the walk so far
+        int processed = 0;  // Files through the pipeline, whatever the outcome
+        int added = 0;
+        int duplicates = 0;
+        int failed = 0;
+        bool scanning = true; // Still walking the folder
+        bool finished = false;
+        bool cancelled = false;
+        std::string current_file; // Name of the file processed last
+    };
+
+    // on_progress is called from the importer thread as files complete, on_finished once
+    // at the end, cancelled or not.
+    LibraryImporter(DatabaseManager& db_manager, LibraryManager& library_manager, TaskExecutor& executor,
+                    int page_width, int page_height,
+                    std::function<void()> on_progress, std::function<void()> on_finished);
+    // Cancels the import and waits for the files in flight. Destroy it before shutting
+    // down the executor.
+    ~LibraryImporter();
+
+    void Start(const fs::path& folder);
+    // Stops queueing files. Those already copied are still recorded.
+    void Cancel();
+
+    fs::path GetFolder() const { return folder_; }
+    Progress GetProgress() const;
+
+private:
+    struct FileResult {
+        enum class Outcome { Added, Duplicate, Failed, Skipped };
+        Outcome outcome = Outcome::Failed;
+        std::string file_name;
+        std::optional<Book> book;
+    };
+
+    void Run();
+    FileResult ProcessFile(const fs::path& path);
+    void CommitBatch(std::vector<Book>& batch);
+    void NotifyProgress();
+
+    DatabaseManager& db_manager_;
+    LibraryManager& library_manager_;
+    TaskExecutor& executor_;
+    int page_width_;
+    int page_height_;
+    std::function<void()> on_progress_;
+    std::function<void()> on_finished_;
+    fs::path folder_;
+    std::thread thread_;
+    CancellationToken cancel_;
+
+    mutable std::mutex progress_mutex_;
+    Progress progress_;
+
+    std::mutex results_mutex_;
+    std::condition_variable results_cv_;
+    std::deque<FileResult> results_; // Finished files not yet collected by the coordinator
+
+    std::mutex claimed_mutex_;
+    std::unordered_set<std::string> claimed_hashes_; // Hashes taken by this import, to catch copies within the folder
+};
+
+#endif // LIBRARY_IMPORTER_H
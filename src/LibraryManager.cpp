@@ -20,15 +20,15 @@
 namespace fs = std::filesystem;
 
 // Helper to create a parser based on file extension
-std::unique_ptr<IBookParser> CreateParserForFile(const std::string& path) {
+std::unique_ptr<IBookParser> CreateParserForFile(const std::string& path, const CancellationToken& cancel = CancellationToken()) {
     std::string extension = fs::path(path).extension().string();
     std::transform(extension.begin(), extension.end(), extension.begin(),
                    [](unsigned char c){ return std::tolower(c); });
 
-    if (extension == ".epub") return std::make_unique<EpubParser>(path);
-    if (extension == ".txt") return std::make_unique<TxtParser>(path);
-    if (extension == ".mobi" || extension == ".azw3") return std::make_unique<MobiParser>(path);
-    if (extension == ".pdf") return std::make_unique<PdfParser>(path);
+    if (extension == ".epub") return std::make_unique<EpubParser>(path, cancel);
+    if (extension == ".txt") return std::make_unique<TxtParser>(path, cancel);
+    if (extension == ".mobi" || extension == ".azw3") return std::make_unique<MobiParser>(path, cancel);
+    if (extension == ".pdf") return std::make_unique<PdfParser>(path, cancel);
     return nullptr;
 }
 
@@ -111,12 +111,12 @@ void LibraryManager::PerformPdfPreflight(Book& book) {
     }
 }
 
-std::string LibraryManager::AddBook(const std::string& source_path, DatabaseManager& db_manager, int screen_w, int screen_h) {
+std::string LibraryManager::AddBook(const std::string& source_path, DatabaseManager& db_manager, TaskExecutor& executor, int screen_w, int screen_h) {
     if (!fs::exists(source_path)) {
         return "Error: Source file does not exist.";
     }
 
-    std::string hash = SystemUtils::CalculateFileHash(source_path);
+    std::string hash = db_manager.GetFileHash(source_path);
     if (hash.empty()) {
         DebugLogger::log("CRITICAL: Hash generation failed for " + source_path);
         return "Error: Could not calculate file hash.";
@@ -135,6 +135,7 @@ std::string LibraryManager::AddBook(const std::string& source_path, DatabaseMana
     try {
         fs::copy_file(source_p, dest_p, fs::copy_options::overwrite_existing);
         DebugLogger::log("Successfully copied file to " + dest_p.string());
+        db_manager.RecordFileHash(dest_p.string(), hash);
     } catch (const fs::filesystem_error& e) {
         DebugLogger::log("ERROR: Failed to copy file: " + std::string(e.what()));
         return "Error copying file: " + std::string(e.what());
@@ -146,28 +147,15 @@ std::string LibraryManager::AddBook(const std::string& source_path, DatabaseMana
     new_book.hash = hash;
     new_book.add_date = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
     new_book.last_read_time = new_book.add_date;
-    
-    std::string extension = source_p.extension().string();
-    if (!extension.empty()) {
-        new_book.format = extension.substr(1);
-        std::transform(new_book.format.begin(), new_book.format.end(), new_book.format.begin(), ::toupper);
-    }
 
-    if (new_book.format == "PDF") {
-        PerformPdfPreflight(new_book);
-        new_book.title = source_p.stem().string();
-        new_book.author = "Unknown Author";
-    } else {
-        auto parser = CreateParserForFile(dest_p.string());
-        if (!parser) {
-            fs::remove(dest_p);
-            DebugLogger::log("ERROR: Unsupported file type for: " + dest_p.string());
-            return "Error: Unsupported file type.";
-        }
-        new_book.title = parser->GetTitle();
-        new_book.author = parser->GetAuthor();
-        
-        BookViewModel temp_model(std::move(parser));
+    auto parser = ReadMetadata(new_book);
+    if (new_book.format.empty() || (new_book.format != "PDF" && !parser)) {
+        fs::remove(dest_p);
+        DebugLogger::log("ERROR: Unsupported file type for: " + dest_p.string());
+        return "Error: Unsupported file type.";
+    }
+    if (parser) {
+        BookViewModel temp_model(std::move(parser), executor);
         temp_model.Paginate(screen_w > 0 ? screen_w - 4 : 80, screen_h > 0 ? screen_h - 8 : 24);
         new_book.total_pages = temp_model.GetTotalPages();
     }
@@ -183,6 +171,71 @@ std::string LibraryManager::AddBook(const std::string& source_path, DatabaseMana
     }
 }
 
+std::unique_ptr<IBookParser> LibraryManager::ReadMetadata(Book& book, const CancellationToken& cancel) {
+    fs::path path(book.path);
+    std::string extension = path.extension().string();
+    if (!extension.empty()) {
+        book.format = extension.substr(1);
+        std::transform(book.format.begin(), book.format.end(), book.format.begin(), ::toupper);
+    }
+
+    if (book.format == "PDF") {
+        PerformPdfPreflight(book);
+        book.title = path.stem().string();
+        book.author = "Unknown Author";
+        return nullptr;
+    }
+
+    auto parser = CreateParserForFile(book.path, cancel);
+    if (!parser) {
+        book.format.clear();
+        return nullptr;
+    }
+    book.title = parser->GetTitle();
+    book.author = parser->GetAuthor();
+    return parser;
+}
+
+std::optional<Book> LibraryManager::PrepareImport(const fs::path& source, const std::string& hash,
+                                                  int page_width, int page_height, const CancellationToken& cancel) {
+    // Without overwrite, copy_file creates the destination exclusively, so two workers
+    // importing files with the same name each end up with their own " (n)" copy.
+    fs::path dest_p;
+    std::error_code ec;
+    for (int n = 1; ; ++n) {
+        std::string name = n == 1 ? source.filename().string()
+                                  : source.stem().string() + " (" + std::to_string(n) + ")" + source.extension().string();
+        dest_p = library_path_ / name;
+        ec.clear();
+        if (fs::exists(dest_p, ec)) continue;
+        if (fs::copy_file(source, dest_p, fs::copy_options::none, ec)) break;
+        if (ec != std::errc::file_exists) {
+            DebugLogger::log("ERROR: Failed to copy " + source.string() + " for import: " + ec.message());
+            return std::nullopt;
+        }
+    }
+
+    Book book;
+    book.uuid = uuid::generate_uuid_v4();
+    book.path = dest_p.string();
+    book.hash = hash;
+    book.add_date = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    book.last_read_time = book.add_date;
+
+    auto parser = ReadMetadata(book, cancel);
+    if (cancel.IsCancelled() || book.format.empty() || (book.format != "PDF" && !parser)) {
+        if (!cancel.IsCancelled()) {
+            DebugLogger::log("ERROR: Unsupported or unreadable file skipped by import: " + source.string());
+        }
+        fs::remove(dest_p, ec);
+        return std::nullopt;
+    }
+    if (parser) {
+        book.total_pages = estimate_page_count(parser->GetChapters(), page_width, page_height);
+    }
+    return book;
+}
+
 bool LibraryManager::DeleteBook(const std::string& book_uuid, DatabaseManager& db_manager, DeleteScope scope) {
     auto book_opt = db_manager.GetBookByUUID(book_uuid);
     if (!book_opt) {
@@ -4,23 +4,42 @@
 #include "DatabaseManager.h"
 #include "CommonTypes.h"
 #include "ConfigManager.h"
+#include "CancellationToken.h"
+#include "TaskExecutor.h"
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include <filesystem>
 
 namespace fs = std::filesystem;
 
+class IBookParser;
+
 class LibraryManager {
 public:
     explicit LibraryManager(const ConfigManager& config_manager);
 
-    std::string AddBook(const std::string& source_path, DatabaseManager& db_manager, int screen_w, int screen_h);
+    // executor is only handed to the BookViewModel that counts the pages; nothing is submitted to it.
+    std::string AddBook(const std::string& source_path, DatabaseManager& db_manager, TaskExecutor& executor, int screen_w, int screen_h);
     bool DeleteBook(const std::string& book_uuid, DatabaseManager& db_manager, DeleteScope scope);
+    // Copies source into the library under a file name nothing else uses and fills in its
+    // record without touching the database, for the bulk importer; safe to call from
+    // several threads at once. total_pages is estimated rather than laid out. Returns
+    // nullopt (logged) if the file cannot be copied or read, or cancel fires first.
+    std::optional<Book> PrepareImport(const fs::path& source, const std::string& hash,
+                                      int page_width, int page_height, const CancellationToken& cancel);
+
+    const fs::path& GetLibraryPath() const { return library_path_; }
 
 private:
     fs::path library_path_;
     void EnsureLibraryExists() const;
     void PerformPdfPreflight(Book& book);
+    // Sets format, title and author from the file at book.path (and the preflight results
+    // for a PDF). Returns the parser it read them with, or nullptr for a PDF or an
+    // unsupported format; unsupported leaves book.format empty.
+    std::unique_ptr<IBookParser> ReadMetadata(Book& book, const CancellationToken& cancel = CancellationToken());
 };
 
 #endif // LIBRARY_MANAGER_H
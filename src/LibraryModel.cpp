@@ -0,0 +1,210 @@
+#include "LibraryModel.h"
+#include "DebugLogger.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+// Upper bound on search results; more than this is not a useful filter.
+constexpr size_t kMaxSearchResults = 1000;
+
+bool same_sort_position(const Book& a, const Book& b, LibrarySortKey sort_key) {
+    LibraryCursor left = LibraryCursor::After(a, sort_key);
+    LibraryCursor right = LibraryCursor::After(b, sort_key);
+    return left.time_key == right.time_key && left.text_key == right.text_key;
+}
+}
+
+LibraryModel::LibraryModel(DatabaseManager& db_manager) : db_manager_(db_manager) {
+    seen_sequence_ = db_manager_.GetLibraryChangeSequence();
+    count_ = db_manager_.GetBookCount();
+}
+
+int64_t LibraryModel::GetChangeSequence() const {
+    return seen_sequence_;
+}
+
+bool LibraryModel::Update(const LibraryChanges& changes) {
+    int64_t before = seen_sequence_;
+    bool reset = ApplyChanges(changes);
+    if (seen_sequence_ != before) {
+        if (!search_query_.empty()) {
+            RunSearch();
+        } else if (reset) {
+            ResetWindow();
+        }
+    }
+    return std::exchange(needs_text_index_, false);
+}
+
+bool LibraryModel::ApplyChanges(const LibraryChanges& changes) {
+    if (changes.sequence <= seen_sequence_) {
+        return false; // Nothing the model has not seen
+    }
+    seen_sequence_ = changes.sequence;
+    needs_text_index_ = needs_text_index_ || changes.needs_text_index;
+
+    if (search_index_.IsBuilt()) {
+        for (const auto& uuid : changes.deleted) {
+            search_index_.Remove(uuid);
+        }
+        for (const auto& book : changes.changed) {
+            search_index_.Upsert(book);
+        }
+    }
+
+    // A row may only be patched in place if it is already in the window and keeps its
+    // sort key; an add, a delete or a move can shift every row below it.
+    bool reset = changes.book_count != count_ || !changes.deleted.empty();
+    count_ = changes.book_count;
+    for (const auto& book : changes.changed) {
+        if (reset) break;
+        auto it = std::find_if(window_rows_.begin(), window_rows_.end(),
+                               [&book](const Book& row) { return row.uuid == book.uuid; });
+        if (it == window_rows_.end() || !same_sort_position(*it, book, sort_key_)) {
+            reset = true;
+        } else {
+            *it = book;
+        }
+    }
+    if (!reset) {
+        display_rows_valid_ = false;
+        generation_++;
+    }
+    return reset;
+}
+
+void LibraryModel::RunSearch() {
+    search_results_ = search_index_.Search(search_query_, kMaxSearchResults);
+    count_ = search_results_.size();
+    ResetWindow();
+}
+
+void LibraryModel::ResetWindow() {
+    cursors_.clear();
+    window_rows_.clear();
+    window_size_ = 0;
+    display_rows_valid_ = false;
+    generation_++;
+}
+
+int LibraryModel::GetCount() const {
+    return count_;
+}
+
+void LibraryModel::SetWindow(int first_row, int row_count) {
+    if (first_row == window_first_ && row_count == window_size_) {
+        return;
+    }
+    window_first_ = first_row;
+    window_size_ = row_count;
+    display_rows_valid_ = false;
+    generation_++;
+
+    if (!search_query_.empty()) {
+        // Search results are already ordered; fetch just the visible ones by key.
+        window_rows_.clear();
+        for (int row = first_row; row < first_row + row_count && row < static_cast<int>(search_results_.size()); ++row) {
+            if (auto book = db_manager_.GetBookByUUID(search_results_[row])) {
+                window_rows_.push_back(*book);
+            }
+        }
+        return;
+    }
+
+    if (first_row == 0) {
+        window_rows_ = db_manager_.GetBooksPage(nullptr, row_count, sort_key_);
+    } else if (auto it = cursors_.find(first_row); it != cursors_.end()) {
+        window_rows_ = db_manager_.GetBooksPage(&it->second, row_count, sort_key_);
+    } else {
+        DebugLogger::log("LibraryModel: no cursor for row " + std::to_string(first_row) + ", falling back to OFFSET.");
+        window_rows_ = db_manager_.GetBooksPageAtOffset(first_row, row_count, sort_key_);
+    }
+
+    // Remember where the next page starts so stepping forward pages by key.
+    if (!window_rows_.empty()) {
+        cursors_[first_row + static_cast<int>(window_rows_.size())] = LibraryCursor::After(window_rows_.back(), sort_key_);
+    }
+}
+
+const Book* LibraryModel::GetBook(int row) const {
+    int index = row - window_first_;
+    if (index < 0 || index >= static_cast<int>(window_rows_.size())) {
+        return nullptr;
+    }
+    return &window_rows_[index];
+}
+
+const std::vector<std::string>& LibraryModel::GetDisplayRows(bool show_sync_status) {
+    if (display_rows_valid_ && display_show_sync_status_ == show_sync_status) {
+        return display_rows_;
+    }
+
+    display_rows_.clear();
+    display_rows_.reserve(window_rows_.size());
+    for (const auto& book : window_rows_) {
+        std::string display_item = book.title + " - " + book.author;
+
+        if (!book.format.empty()) {
+            display_item += " [" + book.format + "]";
+        }
+
+        int progress = 0;
+        if (book.total_pages > 0) {
+            progress = static_cast<int>((static_cast<float>(book.current_page) / book.total_pages) * 100);
+        }
+        display_item += " [" + std::to_string(progress) + "%]";
+
+        if (show_sync_status) {
+            if (book.sync_status == "local") display_item += " [💻]";
+            else if (book.sync_status == "cloud") display_item += " [☁️]";
+            else if (book.sync_status == "synced") display_item += " [✓]";
+        }
+        display_rows_.push_back(display_item);
+    }
+    display_rows_valid_ = true;
+    if (display_show_sync_status_ != show_sync_status) {
+        display_show_sync_status_ = show_sync_status;
+        generation_++;
+    }
+    return display_rows_;
+}
+
+unsigned long LibraryModel::GetGeneration() const {
+    return generation_;
+}
+
+void LibraryModel::SetSortKey(LibrarySortKey sort_key) {
+    if (sort_key == sort_key_) {
+        return;
+    }
+    sort_key_ = sort_key;
+    if (search_query_.empty()) {
+        ResetWindow();
+    }
+}
+
+LibrarySortKey LibraryModel::GetSortKey() const {
+    return sort_key_;
+}
+
+void LibraryModel::SetSearchQuery(const std::string& query) {
+    if (query == search_query_) {
+        return;
+    }
+    search_query_ = query;
+    if (!search_query_.empty() && !search_index_.IsBuilt()) {
+        // The full build covers everything up to now; re-applying older deltas is harmless.
+        search_index_.Build(db_manager_.GetAllBooks());
+    }
+    ApplyChanges(db_manager_.GetLibraryChangesSince(seen_sequence_));
+    if (!search_query_.empty()) {
+        RunSearch();
+    } else {
+        count_ = db_manager_.GetBookCount();
+        ResetWindow();
+    }
+}
+
+const std::string& LibraryModel::GetSearchQuery() const {
+    return search_query_;
+}
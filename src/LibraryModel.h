@@ -0,0 +1,79 @@
+#ifndef LIBRARY_MODEL_H
+#define LIBRARY_MODEL_H
+
+#include "Book.h"
+#include "DatabaseManager.h"
+#include "LibrarySearchIndex.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// A virtualized view of the library table. Only the window of rows on screen is held in
+// memory; it is fetched from SQLite with keyset paging and its display strings are built
+// when first asked for. Memory and open time stay flat however many books there are.
+class LibraryModel {
+public:
+    explicit LibraryModel(DatabaseManager& db_manager);
+
+    // Where the model is in the library's change sequence: pass it to
+    // DatabaseManager::GetLibraryChangesSince to fetch the delta for Update, e.g. off the UI thread.
+    int64_t GetChangeSequence() const;
+    // Catches up with the table from a delta that starts at or before GetChangeSequence();
+    // one the model has already passed is ignored. Rows in the loaded window are patched in
+    // place when their order cannot have changed; otherwise the window is dropped and
+    // fetched again on the next SetWindow. Returns true if a book was added or its file
+    // changed since the last call, i.e. the text index is behind.
+    bool Update(const LibraryChanges& changes);
+    int GetCount() const;
+
+    // Makes rows [first_row, first_row + row_count) the loaded window.
+    void SetWindow(int first_row, int row_count);
+    // Returns nullptr if the row is outside the loaded window.
+    const Book* GetBook(int row) const;
+    const std::vector<std::string>& GetDisplayRows(bool show_sync_status);
+    // Bumped whenever the loaded rows change, so callers can skip re-copying an unchanged window.
+    unsigned long GetGeneration() const;
+
+    // Order of the unfiltered library. Changing it drops the loaded window.
+    void SetSortKey(LibrarySortKey sort_key);
+    LibrarySortKey GetSortKey() const;
+
+    // Type-to-filter search over title, author and format. While a query is set the model
+    // only contains its matches, best first; an empty query shows the whole library again.
+    void SetSearchQuery(const std::string& query);
+    const std::string& GetSearchQuery() const;
+
+private:
+    // Applies a delta to the search index and the loaded window. Returns true if the window
+    // has to be fetched again.
+    bool ApplyChanges(const LibraryChanges& changes);
+    void RunSearch();
+    void ResetWindow();
+
+    DatabaseManager& db_manager_;
+    int count_ = 0;
+    int64_t seen_sequence_ = 0; // Change sequence the model reflects
+    bool needs_text_index_ = false; // Set by ApplyChanges, reported and cleared by Update
+    LibrarySortKey sort_key_ = LibrarySortKey::Recent;
+
+    int window_first_ = 0;
+    int window_size_ = 0;
+    std::vector<Book> window_rows_;
+    std::vector<std::string> display_rows_; // Formatted lazily from window_rows_
+    bool display_rows_valid_ = false;
+    bool display_show_sync_status_ = false;
+    unsigned long generation_ = 0;
+
+    // Cursor after which row N starts, learned as pages are visited; a page whose cursor is
+    // known is fetched by key instead of by OFFSET.
+    std::map<int, LibraryCursor> cursors_;
+
+    // Search. The index is built on the first query and then kept current from the
+    // change deltas passed to Update().
+    LibrarySearchIndex search_index_;
+    std::string search_query_;
+    std::vector<std::string> search_results_; // UUIDs, best first
+};
+
+#endif // LIBRARY_MODEL_H
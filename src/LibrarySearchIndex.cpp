@@ -0,0 +1,217 @@
+#include "LibrarySearchIndex.h"
+#include "DebugLogger.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace {
+// Books whose share of the query's trigrams is at least this are fuzzy matches.
+constexpr double kFuzzyMatchRatio = 0.6;
+
+// ASCII-only lowering; multi-byte UTF-8 sequences pass through and still index byte-wise.
+std::string to_lower(const std::string& text) {
+    std::string lowered = text;
+    for (char& c : lowered) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return lowered;
+}
+
+uint32_t trigram_at(const std::string& text, size_t i) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(text[i])) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8) |
+           static_cast<uint32_t>(static_cast<unsigned char>(text[i + 2]));
+}
+
+std::vector<uint32_t> unique_trigrams(const std::string& text) {
+    std::vector<uint32_t> trigrams;
+    for (size_t i = 0; i + 3 <= text.size(); ++i) {
+        trigrams.push_back(trigram_at(text, i));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+bool starts_word_at(const std::string& text, size_t pos) {
+    return pos == 0 || text[pos - 1] == ' ';
+}
+}
+
+void LibrarySearchIndex::Build(const std::vector<Book>& books) {
+    entries_.clear();
+    slot_by_uuid_.clear();
+    postings_.clear();
+    dead_entries_ = 0;
+    entries_.reserve(books.size());
+    for (const auto& book : books) {
+        AddEntry(book);
+    }
+    built_ = true;
+    DebugLogger::log("LibrarySearchIndex: indexed " + std::to_string(entries_.size()) + " books, " + std::to_string(postings_.size()) + " trigrams.");
+}
+
+void LibrarySearchIndex::Upsert(const Book& book) {
+    Remove(book.uuid);
+    AddEntry(book);
+}
+
+void LibrarySearchIndex::Remove(const std::string& uuid) {
+    auto it = slot_by_uuid_.find(uuid);
+    if (it == slot_by_uuid_.end()) {
+        return;
+    }
+    entries_[it->second].live = false;
+    slot_by_uuid_.erase(it);
+    if (++dead_entries_ > entries_.size() / 2) {
+        Compact();
+    }
+}
+
+void LibrarySearchIndex::AddEntry(const Book& book) {
+    uint32_t slot = entries_.size();
+    Entry entry;
+    entry.uuid = book.uuid;
+    entry.title = to_lower(book.title);
+    entry.haystack = entry.title + " " + to_lower(book.author) + " " + to_lower(book.format);
+    entry.last_read_time = book.last_read_time;
+
+    for (uint32_t trigram : unique_trigrams(entry.haystack)) {
+        postings_[trigram].push_back(slot);
+    }
+    slot_by_uuid_[entry.uuid] = slot;
+    entries_.push_back(std::move(entry));
+}
+
+void LibrarySearchIndex::Compact() {
+    std::vector<Entry> live_entries;
+    live_entries.reserve(entries_.size() - dead_entries_);
+    for (auto& entry : entries_) {
+        if (entry.live) {
+            live_entries.push_back(std::move(entry));
+        }
+    }
+
+    entries_.clear();
+    slot_by_uuid_.clear();
+    postings_.clear();
+    dead_entries_ = 0;
+    for (auto& entry : live_entries) {
+        uint32_t slot = entries_.size();
+        for (uint32_t trigram : unique_trigrams(entry.haystack)) {
+            postings_[trigram].push_back(slot);
+        }
+        slot_by_uuid_[entry.uuid] = slot;
+        entries_.push_back(std::move(entry));
+    }
+}
+
+std::vector<std::string> LibrarySearchIndex::Search(const std::string& query, size_t limit) const {
+    std::vector<std::string> terms;
+    std::istringstream stream(to_lower(query));
+    for (std::string term; stream >> term;) {
+        terms.push_back(term);
+    }
+    if (terms.empty()) {
+        return {};
+    }
+
+    // 1. Candidates: the intersection of every trigram's posting list, shortest list first.
+    std::vector<const std::vector<uint32_t>*> lists;
+    bool missing_trigram = false;
+    for (const auto& term : terms) {
+        for (uint32_t trigram : unique_trigrams(term)) {
+            auto it = postings_.find(trigram);
+            if (it == postings_.end()) {
+                missing_trigram = true;
+                break;
+            }
+            lists.push_back(&it->second);
+        }
+    }
+
+    std::vector<uint32_t> candidates;
+    if (!missing_trigram) {
+        if (lists.empty()) {
+            // Only terms shorter than a trigram; every entry is a candidate.
+            candidates.resize(entries_.size());
+            for (uint32_t slot = 0; slot < entries_.size(); ++slot) candidates[slot] = slot;
+        } else {
+            std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+            candidates = *lists[0];
+            std::vector<uint32_t> narrowed;
+            for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+                narrowed.clear();
+                std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(narrowed));
+                candidates.swap(narrowed);
+            }
+        }
+    }
+
+    // 2. Verify and rank: title prefix, then word starts in the title, then anywhere.
+    struct Hit {
+        uint32_t slot;
+        int score;
+    };
+    std::vector<Hit> hits;
+    for (uint32_t slot : candidates) {
+        const Entry& entry = entries_[slot];
+        if (!entry.live) continue;
+        int score = 0;
+        bool all_found = true;
+        for (const auto& term : terms) {
+            size_t in_title = entry.title.find(term);
+            if (in_title != std::string::npos) {
+                score += in_title == 0 ? 4 : (starts_word_at(entry.title, in_title) ? 3 : 2);
+            } else if (entry.haystack.find(term) != std::string::npos) {
+                score += 1;
+            } else {
+                all_found = false;
+                break;
+            }
+        }
+        if (all_found) {
+            hits.push_back({slot, score});
+        }
+    }
+
+    // 3. Nothing matched exactly: fall back to trigram overlap for typo tolerance.
+    if (hits.empty()) {
+        std::vector<uint32_t> query_trigrams;
+        for (const auto& term : terms) {
+            auto term_trigrams = unique_trigrams(term);
+            query_trigrams.insert(query_trigrams.end(), term_trigrams.begin(), term_trigrams.end());
+        }
+        if (query_trigrams.empty()) {
+            return {};
+        }
+        std::unordered_map<uint32_t, int> shared;
+        for (uint32_t trigram : query_trigrams) {
+            auto it = postings_.find(trigram);
+            if (it == postings_.end()) continue;
+            for (uint32_t slot : it->second) {
+                shared[slot]++;
+            }
+        }
+        int threshold = std::max(1, static_cast<int>(query_trigrams.size() * kFuzzyMatchRatio + 0.5));
+        for (const auto& [slot, count] : shared) {
+            if (count >= threshold && entries_[slot].live) {
+                hits.push_back({slot, count});
+            }
+        }
+    }
+
+    auto better = [this](const Hit& a, const Hit& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return entries_[a.slot].last_read_time > entries_[b.slot].last_read_time;
+    };
+    size_t result_count = std::min(limit, hits.size());
+    std::partial_sort(hits.begin(), hits.begin() + result_count, hits.end(), better);
+
+    std::vector<std::string> results;
+    results.reserve(result_count);
+    for (size_t i = 0; i < result_count; ++i) {
+        results.push_back(entries_[hits[i].slot].uuid);
+    }
+    return results;
+}
@@ -0,0 +1,47 @@
+#ifndef LIBRARY_SEARCH_INDEX_H
+#define LIBRARY_SEARCH_INDEX_H
+
+#include "Book.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// In-memory trigram index over each book's title, author and format, for type-to-filter
+// search in the library. Queries intersect posting lists and verify the survivors, so a
+// keystroke costs time proportional to the matches rather than to the library size.
+// Not thread-safe; LibraryModel serializes access.
+class LibrarySearchIndex {
+public:
+    void Build(const std::vector<Book>& books);
+    void Upsert(const Book& book);
+    void Remove(const std::string& uuid);
+    bool IsBuilt() const { return built_; }
+
+    // Returns the UUIDs of matching books, best first. Every whitespace-separated term must
+    // appear as a substring; if nothing does, books sharing most of the query's trigrams are
+    // returned instead, which tolerates typos.
+    std::vector<std::string> Search(const std::string& query, size_t limit) const;
+
+private:
+    struct Entry {
+        std::string uuid;
+        std::string title;    // Lower-cased
+        std::string haystack; // Lower-cased "title author format"
+        time_t last_read_time = 0;
+        bool live = true;
+    };
+
+    void AddEntry(const Book& book);
+    void Compact();
+
+    // Entries are only ever appended, so every posting list stays sorted by slot. Removed
+    // and replaced entries are marked dead and dropped at the next compaction.
+    std::vector<Entry> entries_;
+    std::unordered_map<std::string, uint32_t> slot_by_uuid_;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings_; // Trigram -> entry slots
+    size_t dead_entries_ = 0;
+    bool built_ = false;
+};
+
+#endif // LIBRARY_SEARCH_INDEX_H
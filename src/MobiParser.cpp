@@ -15,6 +15,7 @@ struct MobiParser::Impl {
     std::string title = "Unknown Title";
     std::string author = "Unknown Author";
     std::vector<BookChapter> chapters;
+    CancellationToken cancel;
 
     ~Impl() {}
 
@@ -115,6 +116,7 @@ struct MobiParser::Impl {
                 [&](size_t entry_index) -> BookChapter {
                 MOBIIndexEntry* entry = &rawml->ncx->entries[entry_index];
                 BookChapter chapter;
+                if (cancel.IsCancelled()) return chapter;
 
                 // Find the content for this chapter
                 size_t content_uid = 0;
@@ -161,6 +163,7 @@ struct MobiParser::Impl {
 
             // Build the tree starting from the root entries
             for (size_t root_index : root_entries) {
+                if (cancel.IsCancelled()) break;
                 chapters.push_back(build_chapter_tree(root_index));
             }
         } 
@@ -169,7 +172,7 @@ struct MobiParser::Impl {
         if (chapters.empty()) {
             DebugLogger::log("No chapters built from NCX. Using fallback on flow/markup.");
             MOBIPart* part = rawml->flow ? rawml->flow : rawml->markup;
-            while (part != nullptr) {
+            while (part != nullptr && !cancel.IsCancelled()) {
                 if (part->type == T_HTML) {
                     BookChapter chapter;
                     chapter.title = "Chapter " + std::to_string(chapters.size() + 1);
@@ -190,8 +193,9 @@ struct MobiParser::Impl {
     }
 };
 
-MobiParser::MobiParser(const std::string& file_path) : pimpl_(std::make_unique<Impl>()) {
+MobiParser::MobiParser(const std::string& file_path, const CancellationToken& cancel) : pimpl_(std::make_unique<Impl>()) {
     pimpl_->file_path = file_path;
+    pimpl_->cancel = cancel;
     DebugLogger::init("debug.log");
     DebugLogger::log("--- Starting MOBI Parse for: " + file_path + " ---");
     pimpl_->parse();
@@ -1,6 +1,7 @@
 #ifndef MOBI_PARSER_H
 #define MOBI_PARSER_H
 
+#include "CancellationToken.h"
 #include "IBookParser.h"
 #include <string>
 #include <vector>
@@ -8,7 +9,8 @@
 
 class MobiParser : public IBookParser {
 public:
-    MobiParser(const std::string& file_path);
+    // Parsing stops early, leaving a partial book, if cancel is triggered.
+    MobiParser(const std::string& file_path, const CancellationToken& cancel = CancellationToken());
     ~MobiParser() override;
 
     std::string GetTitle() const override;
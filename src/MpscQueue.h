@@ -0,0 +1,56 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// Unbounded multi-producer, single-consumer FIFO. Push() never blocks and is safe from
+// any thread; TryPop() must only ever be called from one thread at a time. Producers
+// swing a shared head pointer, the consumer walks behind them from a stub node, so the
+// two sides never share a lock. A push that is still linking its node in may be missed
+// by a concurrent TryPop(); it shows up on the next one.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(new Node()), tail_(head_.load()) {}
+
+    ~MpscQueue() {
+        T discarded;
+        while (TryPop(discarded)) {}
+        delete tail_;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void Push(T value) {
+        Node* node = new Node();
+        node->value = std::move(value);
+        Node* previous = head_.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    bool TryPop(T& out) {
+        Node* next = tail_->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        // next becomes the new stub; its value is handed out and the old stub freed.
+        out = std::move(next->value);
+        next->value = T();
+        delete tail_;
+        tail_ = next;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    std::atomic<Node*> head_; // Most recently pushed node
+    Node* tail_;              // Stub; owned by the consumer
+};
+
+#endif // MPSC_QUEUE_H
@@ -16,8 +16,8 @@ static std::string to_std_string(const poppler::ustring& ustr) {
     return std::string(utf8_bytes.data(), utf8_bytes.size());
 }
 
-PdfParser::PdfParser(const std::string& file_path)
-    : file_path_(file_path) {
+PdfParser::PdfParser(const std::string& file_path, const CancellationToken& cancel)
+    : file_path_(file_path), cancel_(cancel) {
     DebugLogger::log("PdfParser instance created for: " + file_path_);
     // Constructor no longer loads the document.
 }
@@ -26,6 +26,10 @@ bool PdfParser::Load() {
     DebugLogger::log("PdfParser: Calling poppler::document::load_from_file... This may take time.");
     doc_ = std::unique_ptr<poppler::document>(poppler::document::load_from_file(file_path_));
     DebugLogger::log("PdfParser: poppler::document::load_from_file finished.");
+    if (cancel_.IsCancelled()) {
+        doc_.reset(); // Poppler's load itself cannot be interrupted; drop the result
+        return false;
+    }
     
     if (!doc_ || doc_->is_locked()) {
         DebugLogger::log("PdfParser: Failed to load or locked PDF.");
@@ -38,7 +42,7 @@ bool PdfParser::Load() {
     if (total_pages > 0) {
         const int pages_to_check = std::min(5, total_pages);
         long total_chars = 0;
-        for (int i = 0; i < pages_to_check; ++i) {
+        for (int i = 0; i < pages_to_check && !cancel_.IsCancelled(); ++i) {
             std::unique_ptr<poppler::page> p(doc_->create_page(i));
             if (p) {
                 total_chars += p->text().to_utf8().size();
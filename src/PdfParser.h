@@ -1,6 +1,7 @@
 #ifndef PDFPARSER_H
 #define PDFPARSER_H
 
+#include "CancellationToken.h"
 #include "IBookParser.h"
 #include <string>
 #include <vector>
@@ -13,7 +14,7 @@ namespace poppler {
 
 class PdfParser : public IBookParser {
 public:
-    explicit PdfParser(const std::string& file_path);
+    explicit PdfParser(const std::string& file_path, const CancellationToken& cancel = CancellationToken());
     ~PdfParser() override;
 
     bool Load(); // New method to perform the actual loading
@@ -41,6 +42,7 @@ private:
     int total_pages_ = -1; // Cache for total pages
     std::map<int, std::string> page_text_cache_;
     bool is_image_based_ = false;
+    CancellationToken cancel_;
 };
 
 #endif // PDFPARSER_H
@@ -0,0 +1,129 @@
+#include "PerfStats.h"
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+
+namespace {
+// Samples kept per stage; percentiles are over this window.
+constexpr size_t kWindowSize = 512;
+
+const char* const kStageNames[] = {"Event", "Paginate", "Page content", "Build", "Render", "Flush"};
+static_assert(sizeof(kStageNames) / sizeof(kStageNames[0]) == static_cast<size_t>(PerfStage::Count), "Name every stage");
+
+struct Window {
+    std::array<double, kWindowSize> samples_ms{};
+    size_t next = 0;
+    size_t count = 0;
+};
+
+std::mutex stats_mutex;
+std::array<Window, static_cast<size_t>(PerfStage::Count)> windows;
+std::deque<std::chrono::steady_clock::time_point> frame_times; // Completed frames, last second only
+
+void drop_old_frames(std::chrono::steady_clock::time_point now) {
+    while (!frame_times.empty() && now - frame_times.front() > std::chrono::seconds(1)) {
+        frame_times.pop_front();
+    }
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// Forwards to the real stdout buffer and times the writes of each frame. The time spent
+// writing since the last flush, plus the flush itself, is one Flush sample.
+class TimedStreamBuf : public std::streambuf {
+public:
+    explicit TimedStreamBuf(std::streambuf* target) : target_(target) {}
+    std::streambuf* target() const { return target_; }
+
+protected:
+    int overflow(int c) override {
+        auto start = std::chrono::steady_clock::now();
+        int result = c == traits_type::eof() ? traits_type::not_eof(c) : target_->sputc(traits_type::to_char_type(c));
+        pending_ += std::chrono::steady_clock::now() - start;
+        return result;
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        auto start = std::chrono::steady_clock::now();
+        std::streamsize written = target_->sputn(s, n);
+        pending_ += std::chrono::steady_clock::now() - start;
+        return written;
+    }
+
+    int sync() override {
+        auto start = std::chrono::steady_clock::now();
+        int result = target_->pubsync();
+        PerfStats::Record(PerfStage::Flush, pending_ + (std::chrono::steady_clock::now() - start));
+        pending_ = {};
+        return result;
+    }
+
+private:
+    std::streambuf* target_;
+    std::chrono::steady_clock::duration pending_{};
+};
+
+TimedStreamBuf* flush_timer = nullptr;
+}
+
+void PerfStats::Record(PerfStage stage, std::chrono::steady_clock::duration elapsed) {
+    double ms = std::chrono::duration<double, std::milli>(elapsed).count();
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    Window& window = windows[static_cast<size_t>(stage)];
+    window.samples_ms[window.next] = ms;
+    window.next = (window.next + 1) % kWindowSize;
+    window.count = std::min(window.count + 1, kWindowSize);
+}
+
+void PerfStats::RecordFrame() {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    frame_times.push_back(now);
+    drop_old_frames(now);
+}
+
+std::vector<PerfSummary> PerfStats::GetSummaries() {
+    std::vector<PerfSummary> summaries;
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    for (size_t i = 0; i < windows.size(); ++i) {
+        const Window& window = windows[i];
+        PerfSummary summary;
+        summary.stage = kStageNames[i];
+        summary.samples = window.count;
+        if (window.count > 0) {
+            std::vector<double> sorted(window.samples_ms.begin(), window.samples_ms.begin() + window.count);
+            std::sort(sorted.begin(), sorted.end());
+            summary.p50_ms = percentile(sorted, 0.50);
+            summary.p95_ms = percentile(sorted, 0.95);
+            summary.p99_ms = percentile(sorted, 0.99);
+            summary.max_ms = sorted.back();
+        }
+        summaries.push_back(summary);
+    }
+    return summaries;
+}
+
+int PerfStats::GetFramesPerSecond() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    drop_old_frames(std::chrono::steady_clock::now());
+    return static_cast<int>(frame_times.size());
+}
+
+void PerfStats::InstallFlushTimer() {
+    if (flush_timer) return;
+    flush_timer = new TimedStreamBuf(std::cout.rdbuf());
+    std::cout.rdbuf(flush_timer);
+}
+
+void PerfStats::RemoveFlushTimer() {
+    if (!flush_timer) return;
+    std::cout.rdbuf(flush_timer->target());
+    delete flush_timer;
+    flush_timer = nullptr;
+}
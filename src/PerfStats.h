@@ -0,0 +1,58 @@
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Stages of getting a frame on screen that are worth timing.
+enum class PerfStage {
+    Event,       // Handling one input event
+    Paginate,    // Laying out the whole book (foreground or background)
+    PageContent, // Fetching a page (or scroll-mode lines) for display
+    Build,       // Building the view's element tree
+    Render,      // FTXUI layout and drawing into the screen buffer
+    Flush,       // Writing the frame to the terminal
+    Count
+};
+
+struct PerfSummary {
+    std::string stage;
+    size_t samples = 0;
+    double p50_ms = 0;
+    double p95_ms = 0;
+    double p99_ms = 0;
+    double max_ms = 0;
+};
+
+// Process-wide rolling latency statistics. Recording is a short critical section, so hooks
+// can stay in place in release builds; each stage keeps only its most recent samples.
+class PerfStats {
+public:
+    static void Record(PerfStage stage, std::chrono::steady_clock::duration elapsed);
+    static void RecordFrame();
+
+    static std::vector<PerfSummary> GetSummaries();
+    static int GetFramesPerSecond(); // Frames completed during the last second
+
+    // Times writes to std::cout as the Flush stage, one sample per flush.
+    static void InstallFlushTimer();
+    static void RemoveFlushTimer();
+};
+
+// Records the lifetime of the scope as one sample of a stage.
+class ScopedPerfTimer {
+public:
+    explicit ScopedPerfTimer(PerfStage stage) : stage_(stage), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedPerfTimer() { PerfStats::Record(stage_, std::chrono::steady_clock::now() - start_); }
+
+    ScopedPerfTimer(const ScopedPerfTimer&) = delete;
+    ScopedPerfTimer& operator=(const ScopedPerfTimer&) = delete;
+
+private:
+    PerfStage stage_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#endif // PERF_STATS_H
@@ -6,13 +6,12 @@
 #include <map>
 #include <set>
 #include <fstream>
-#include <thread>
 
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
-SyncController::SyncController(DatabaseManager& db_manager, GoogleDriveManager& drive_manager, ConfigManager& config_manager)
-    : db_manager_(db_manager), drive_manager_(drive_manager), config_manager_(config_manager) {}
+SyncController::SyncController(DatabaseManager& db_manager, GoogleDriveManager& drive_manager, ConfigManager& config_manager, TaskExecutor& executor)
+    : db_manager_(db_manager), drive_manager_(drive_manager), config_manager_(config_manager), executor_(executor) {}
 
 void SyncController::full_sync(std::function<void(bool, std::string)> callback) {
     DebugLogger::log("Starting full sync...");
@@ -96,7 +95,7 @@ void SyncController::full_sync(std::function<void(bool, std::string)> callback)
 }
 
 void SyncController::get_latest_progress_async(const std::string& book_uuid, std::function<void(Book, bool)> callback) {
-    std::thread([this, book_uuid, callback] {
+    executor_.Submit(TaskPriority::Io, [this, book_uuid, callback] {
         auto book_opt = db_manager_.GetBookByUUID(book_uuid);
         if (!book_opt) {
             callback({}, false);
@@ -122,10 +121,13 @@ void SyncController::get_latest_progress_async(const std::string& book_uuid, std
         if (remote_timestamp > local_book.last_read_time) {
             db_manager_.UpdateProgressAndTimestamp(local_book.uuid, remote_page, remote_timestamp);
             local_book.current_page = remote_page;
+            // The database row's position was cleared with it; the stale one would win over
+            // the remote page when the book opens.
+            local_book.position = ReadingPosition();
             local_book.last_read_time = remote_timestamp;
         }
         callback(local_book, true);
-    }).detach();
+    });
 }
 
 void SyncController::sync_progress_before_local_delete(const std::string& book_uuid) {
@@ -157,10 +159,10 @@ void SyncController::upload_progress_async(const Book& book, std::function<void(
         if(callback) callback(false);
         return;
     }
-    std::thread([this, book, callback] {
+    executor_.Submit(TaskPriority::Background, [this, book, callback] {
         bool success = drive_manager_.update_file_metadata(book);
         if (callback) callback(success);
-    }).detach();
+    });
 }
 
 
@@ -197,7 +199,7 @@ void SyncController::download_book(const Book& book, const std::string& dest_fol
     bool success = drive_manager_.download_file(book.google_drive_file_id, dest_path.string());
 
     if (success) {
-        std::string hash = SystemUtils::CalculateFileHash(dest_path.string());
+        std::string hash = db_manager_.GetFileHash(dest_path.string());
         db_manager_.UpdateBookFields(book.uuid, dest_path.string(), hash);
         callback(true, "Download successful.");
     } else {
@@ -206,7 +208,7 @@ void SyncController::download_book(const Book& book, const std::string& dest_fol
 }
 
 void SyncController::verify_and_download_book_async(const Book& book, const std::string& dest_folder, std::function<void(bool, std::string)> callback) {
-    std::thread([this, book, dest_folder, callback] {
+    executor_.Submit(TaskPriority::Io, [this, book, dest_folder, callback] {
         // 1. Pre-flight check
         DriveFile metadata = drive_manager_.get_file_metadata(book.google_drive_file_id);
         if (metadata.id.empty()) {
@@ -225,17 +227,17 @@ void SyncController::verify_and_download_book_async(const Book& book, const std:
         bool success = drive_manager_.download_file(book.google_drive_file_id, dest_path.string());
 
         if (success) {
-            std::string hash = SystemUtils::CalculateFileHash(dest_path.string());
+            std::string hash = db_manager_.GetFileHash(dest_path.string());
             db_manager_.UpdateBookFields(book.uuid, dest_path.string(), hash);
             callback(true, "Download successful.");
         } else {
             callback(false, "Download failed.");
         }
-    }).detach();
+    });
 }
 
 void SyncController::delete_cloud_file_async(const std::string& book_uuid, std::function<void(bool)> callback) {
-    std::thread([this, book_uuid, callback]() {
+    executor_.Submit(TaskPriority::Io, [this, book_uuid, callback]() {
         auto book_opt = db_manager_.GetBookByUUID(book_uuid);
         if (!book_opt || book_opt->google_drive_file_id.empty()) {
             if (callback) callback(false);
@@ -249,5 +251,5 @@ void SyncController::delete_cloud_file_async(const std::string& book_uuid, std::
         }
 
         if (callback) callback(success);
-    }).detach();
+    });
 }
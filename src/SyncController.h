@@ -10,10 +10,12 @@
 #include "ConfigManager.h"
 #include "nlohmann/json.hpp"
 #include "CommonTypes.h"
+#include "TaskExecutor.h"
 
 class SyncController {
 public:
-    SyncController(DatabaseManager& db_manager, GoogleDriveManager& drive_manager, ConfigManager& config_manager);
+    // The *_async calls run on executor and invoke their callback from a worker thread.
+    SyncController(DatabaseManager& db_manager, GoogleDriveManager& drive_manager, ConfigManager& config_manager, TaskExecutor& executor);
 
     void full_sync(std::function<void(bool, std::string)> callback);
     void get_latest_progress_async(const std::string& book_uuid, std::function<void(Book, bool)> callback);
@@ -30,6 +32,7 @@ private:
     DatabaseManager& db_manager_;
     GoogleDriveManager& drive_manager_;
     ConfigManager& config_manager_;
+    TaskExecutor& executor_;
 };
 
 #endif // SYNC_CONTROLLER_H
@@ -6,11 +6,22 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <algorithm>
 #include <array>
 #include <filesystem>
 #include <fstream>
 #include <vector>
 #include <cstdlib> // For getenv
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+namespace {
+// Size of each read CalculateFileHash hashes. Large enough to keep the disk streaming.
+constexpr std::streamsize kHashChunkSize = 1024 * 1024;
+// Size of each block CalculateSampleHash reads.
+constexpr std::streamsize kSampleBlockSize = 64 * 1024;
+}
 
 std::string SystemUtils::GetHomePath() {
     #ifdef _WIN32
@@ -47,8 +58,57 @@ std::string SystemUtils::CalculateFileHash(const std::string& file_path) {
         DebugLogger::log("ERROR: Could not open file for hashing: " + file_path);
         return "";
     }
-    std::vector<char> file_buffer((std::istreambuf_iterator<char>(file_stream)), std::istreambuf_iterator<char>());
-    return picosha2::hash256_hex_string(file_buffer);
+    // Hash a chunk at a time so memory stays constant whatever the file size.
+    std::vector<char> chunk(kHashChunkSize);
+    picosha2::hash256_one_by_one hasher;
+    while (file_stream.read(chunk.data(), kHashChunkSize) || file_stream.gcount() > 0) {
+        hasher.process(chunk.begin(), chunk.begin() + file_stream.gcount());
+    }
+    if (file_stream.bad()) {
+        DebugLogger::log("ERROR: Could not read file for hashing: " + file_path);
+        return "";
+    }
+    hasher.finish();
+    std::vector<unsigned char> digest(picosha2::k_digest_size);
+    hasher.get_hash_bytes(digest.begin(), digest.end());
+    return picosha2::get_hash_hex_string(digest);
+}
+
+bool SystemUtils::GetFileStat(const std::string& file_path, FileStat& stat) {
+    std::error_code ec;
+    stat.size = fs::file_size(file_path, ec);
+    if (ec) return false;
+    auto mtime = fs::last_write_time(file_path, ec);
+    if (ec) return false;
+    stat.mtime = mtime.time_since_epoch().count();
+    #ifndef _WIN32
+        struct stat st;
+        if (::stat(file_path.c_str(), &st) != 0) return false;
+        stat.device = static_cast<uint64_t>(st.st_dev);
+        stat.inode = static_cast<uint64_t>(st.st_ino);
+    #endif
+    return true;
+}
+
+std::string SystemUtils::CalculateSampleHash(const std::string& file_path) {
+    std::ifstream file_stream(file_path, std::ios::binary);
+    std::error_code ec;
+    auto size = fs::file_size(file_path, ec);
+    if (!file_stream || ec) {
+        DebugLogger::log("ERROR: Could not open file for sampling: " + file_path);
+        return "";
+    }
+
+    std::string sample = std::to_string(size) + ":";
+    std::vector<char> block(kSampleBlockSize);
+    std::streamoff offsets[] = {0, static_cast<std::streamoff>(size / 2), static_cast<std::streamoff>(size) - kSampleBlockSize};
+    for (std::streamoff offset : offsets) {
+        file_stream.clear();
+        file_stream.seekg(std::max<std::streamoff>(offset, 0));
+        file_stream.read(block.data(), kSampleBlockSize);
+        sample.append(block.data(), static_cast<size_t>(file_stream.gcount()));
+    }
+    return picosha2::hash256_hex_string(sample);
 }
 
 std::string SystemUtils::ExpandTilde(const std::string& path) {
@@ -1,6 +1,7 @@
 #ifndef SYSTEM_UTILS_H
 #define SYSTEM_UTILS_H
 
+#include <cstdint>
 #include <string>
 #include <filesystem>
 
@@ -14,6 +15,20 @@ namespace SystemUtils {
     
     std::string ExecuteCommand(const std::string& cmd);
     std::string CalculateFileHash(const std::string& file_path);
+
+    // What the filesystem says about a file without reading it. While all four stay the
+    // same the contents have almost certainly not changed.
+    struct FileStat {
+        uint64_t device = 0; // 0 where the platform has no device/inode numbers
+        uint64_t inode = 0;
+        uint64_t size = 0;
+        int64_t mtime = 0;   // Ticks of the filesystem clock
+    };
+    bool GetFileStat(const std::string& file_path, FileStat& stat);
+    // SHA-256 over the file size and a block each from the start, middle and end. A few
+    // reads whatever the size; used to confirm a full hash taken earlier still applies.
+    std::string CalculateSampleHash(const std::string& file_path);
+
     std::string get_file_extension(const std::string& filename);
 }
 
@@ -0,0 +1,198 @@
+#include "TaskExecutor.h"
+#include "DebugLogger.h"
+#include <algorithm>
+#include <exception>
+
+namespace {
+// The tasks are mostly network and disk bound; a few workers keep a sync pass from
+// flooding the connection while a book still opens promptly.
+constexpr size_t kMinDefaultWorkers = 2;
+constexpr size_t kMaxDefaultWorkers = 4;
+
+// Lets Submit() from inside a task queue onto the calling worker.
+thread_local const TaskExecutor* current_executor = nullptr;
+thread_local size_t current_worker = 0;
+}
+
+bool TaskHandle::IsDone() const {
+    if (!state_) return true;
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->status == Status::Finished || state_->status == Status::Discarded;
+}
+
+bool TaskHandle::Cancel() {
+    if (!state_) return false;
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->status != Status::Pending) return false;
+    state_->status = Status::Discarded;
+    state_->cv.notify_all();
+    return true;
+}
+
+void TaskHandle::Wait() const {
+    if (!state_) return;
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->cv.wait(lock, [this] {
+        return state_->status == Status::Finished || state_->status == Status::Discarded;
+    });
+}
+
+TaskExecutor::TaskExecutor(size_t worker_count) {
+    if (worker_count == 0) {
+        worker_count = std::clamp<size_t>(std::thread::hardware_concurrency(), kMinDefaultWorkers, kMaxDefaultWorkers);
+    }
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    max_background_ = std::max<size_t>(1, worker_count - 1);
+    // Start the threads only once every queue exists, since any of them may steal.
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers_[i]->thread = std::thread(&TaskExecutor::WorkerLoop, this, i);
+    }
+    DebugLogger::log("[TaskExecutor] Started " + std::to_string(worker_count) + " workers.");
+}
+
+TaskExecutor::~TaskExecutor() {
+    Shutdown();
+}
+
+TaskHandle TaskExecutor::Submit(TaskPriority priority, std::function<void()> fn) {
+    auto state = std::make_shared<TaskHandle::State>();
+    std::unique_lock<std::mutex> wake_lock(wake_mutex_);
+    if (stopping_) {
+        state->status = TaskHandle::Status::Discarded;
+        return TaskHandle(state);
+    }
+
+    int level = static_cast<int>(priority);
+    if (current_executor == this) {
+        // Newest first on the own queue keeps follow-up work hot; thieves take from the back.
+        Worker& worker = *workers_[current_worker];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[level].push_front(Task{std::move(fn), state});
+    } else {
+        Worker& worker = *workers_[next_worker_++ % workers_.size()];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[level].push_back(Task{std::move(fn), state});
+    }
+    queued_[level]++;
+    wake_lock.unlock();
+    wake_cv_.notify_one();
+    return TaskHandle(state);
+}
+
+void TaskExecutor::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        if (stopping_) return;
+        stopping_ = true;
+    }
+    wake_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    // Whatever never started is dropped, releasing anyone waiting on it.
+    size_t discarded = 0;
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        for (auto& queue : worker->queues) {
+            for (auto& task : queue) {
+                Finish(*task.state, TaskHandle::Status::Discarded);
+                discarded++;
+            }
+            queue.clear();
+        }
+    }
+    DebugLogger::log("[TaskExecutor] Shut down; " + std::to_string(discarded) + " queued tasks discarded.");
+}
+
+void TaskExecutor::WorkerLoop(size_t index) {
+    current_executor = this;
+    current_worker = index;
+
+    const int background = static_cast<int>(TaskPriority::Background);
+    while (true) {
+        int level;
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait(lock, [this] { return stopping_ || NextRunnableLevel() >= 0; });
+            if (stopping_) return;
+            level = NextRunnableLevel();
+            queued_[level]--;
+            if (level == background) running_background_++;
+        }
+
+        Task task;
+        if (TryTake(index, level, task)) {
+            bool discarded;
+            {
+                std::lock_guard<std::mutex> lock(task.state->mutex);
+                discarded = task.state->status == TaskHandle::Status::Discarded; // Cancelled while queued
+                if (!discarded) task.state->status = TaskHandle::Status::Running;
+            }
+            if (!discarded) {
+                try {
+                    task.fn();
+                } catch (const std::exception& e) {
+                    DebugLogger::log(std::string("[TaskExecutor] Task threw: ") + e.what());
+                } catch (...) {
+                    DebugLogger::log("[TaskExecutor] Task threw an unknown exception.");
+                }
+                Finish(*task.state, TaskHandle::Status::Finished);
+            }
+        }
+
+        if (level == background) {
+            {
+                std::lock_guard<std::mutex> lock(wake_mutex_);
+                running_background_--;
+            }
+            // A Background task held back by the cap may run now.
+            wake_cv_.notify_one();
+        }
+    }
+}
+
+int TaskExecutor::NextRunnableLevel() const {
+    for (int level = 0; level < kPriorityCount; ++level) {
+        if (queued_[level] == 0) continue;
+        if (level == static_cast<int>(TaskPriority::Background) && running_background_ >= max_background_) {
+            return -1;
+        }
+        return level;
+    }
+    return -1;
+}
+
+bool TaskExecutor::TryTake(size_t index, int level, Task& task) {
+    // Own queue first, from the front...
+    {
+        Worker& own = *workers_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.queues[level].empty()) {
+            task = std::move(own.queues[level].front());
+            own.queues[level].pop_front();
+            return true;
+        }
+    }
+    // ...then the back of a peer's queue at the same priority.
+    for (size_t offset = 1; offset < workers_.size(); ++offset) {
+        Worker& victim = *workers_[(index + offset) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.queues[level].empty()) {
+            task = std::move(victim.queues[level].back());
+            victim.queues[level].pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskExecutor::Finish(TaskHandle::State& state, TaskHandle::Status status) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.status = status;
+    state.cv.notify_all();
+}
@@ -0,0 +1,107 @@
+#ifndef TASK_EXECUTOR_H
+#define TASK_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Order in which queued work is picked up. A free worker always takes the most urgent
+// task available anywhere before it looks at a lower priority. Running tasks are never
+// preempted, so Background work is held to one worker fewer than the pool: however much
+// of it is queued, a worker stays free for anything more urgent.
+enum class TaskPriority {
+    UiCritical, // Local work the user is waiting on, e.g. opening a book; never network calls
+    Io,         // Network and disk work started by the user
+    Background  // Sync passes and other work nobody is watching
+};
+
+// Refers to one submitted task. Copies share the task; a default-constructed handle
+// refers to nothing and counts as done.
+class TaskHandle {
+public:
+    TaskHandle() = default;
+
+    // True once the task has run or was discarded without running.
+    bool IsDone() const;
+    // Discards the task if no worker has started it yet. Returns true if it was discarded.
+    bool Cancel();
+    // Blocks until the task has run or was discarded. Never call it from a task on the
+    // same executor.
+    void Wait() const;
+
+private:
+    friend class TaskExecutor;
+
+    enum class Status { Pending, Running, Finished, Discarded };
+    struct State {
+        std::mutex mutex;
+        std::condition_variable cv;
+        Status status = Status::Pending;
+    };
+
+    explicit TaskHandle(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+    std::shared_ptr<State> state_;
+};
+
+// A fixed pool of worker threads shared by every subsystem that runs work off the UI
+// thread. Each worker owns a queue per priority; tasks submitted from a worker go onto
+// its own queue, others are spread round-robin, and an idle worker steals from the far
+// end of a peer's queue. The pool size bounds how much runs at once, however much is
+// queued.
+class TaskExecutor {
+public:
+    // worker_count 0 picks a size from the hardware concurrency.
+    explicit TaskExecutor(size_t worker_count = 0);
+    ~TaskExecutor();
+
+    TaskExecutor(const TaskExecutor&) = delete;
+    TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+    // Queues fn. After Shutdown() the task is discarded straight away.
+    TaskHandle Submit(TaskPriority priority, std::function<void()> fn);
+    // Stops accepting work, lets running tasks finish, discards the rest and joins the
+    // workers. Call before destroying anything the tasks use; not from a task.
+    void Shutdown();
+
+    size_t GetWorkerCount() const { return workers_.size(); }
+
+private:
+    static constexpr int kPriorityCount = 3;
+
+    struct Task {
+        std::function<void()> fn;
+        std::shared_ptr<TaskHandle::State> state;
+    };
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> queues[kPriorityCount];
+        std::thread thread;
+    };
+
+    void WorkerLoop(size_t index);
+    // Picks the priority a woken worker should take from, or -1 if nothing may run yet.
+    // Call with wake_mutex_ held.
+    int NextRunnableLevel() const;
+    bool TryTake(size_t index, int level, Task& task);
+    static void Finish(TaskHandle::State& state, TaskHandle::Status status);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    // Guarded by wake_mutex_. A worker claims a task by decrementing its level's count
+    // before taking it from the queues, so a claimed task is always there to take.
+    size_t queued_[kPriorityCount] = {};
+    size_t running_background_ = 0;
+    size_t max_background_ = 1;
+    bool stopping_ = false;
+    std::atomic<size_t> next_worker_{0};
+};
+
+#endif // TASK_EXECUTOR_H
@@ -0,0 +1,108 @@
+#include "TextIndexer.h"
+#include "BookViewModel.h"
+#include "DebugLogger.h"
+#include "PdfParser.h"
+#include "UIUtils.h"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+TextIndexer::TextIndexer(DatabaseManager& db_manager, std::function<void()> on_progress)
+    : db_manager_(db_manager), on_progress_(std::move(on_progress)) {}
+
+TextIndexer::~TextIndexer() {
+    Stop();
+}
+
+void TextIndexer::Start() {
+    if (thread_.joinable() || !db_manager_.IsTextSearchAvailable()) return;
+    thread_ = std::thread(&TextIndexer::IndexLoop, this);
+}
+
+void TextIndexer::RequestScan() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        scan_requested_ = true;
+    }
+    cv_.notify_all();
+}
+
+void TextIndexer::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    parse_token_.Cancel();
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void TextIndexer::IndexLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || scan_requested_; });
+            if (stop_) return;
+            scan_requested_ = false;
+        }
+
+        std::vector<std::string> uuids = db_manager_.GetBookUuidsNeedingTextIndex();
+        if (uuids.empty()) continue;
+        DebugLogger::log("[TextIndexer] " + std::to_string(uuids.size()) + " books to index.");
+
+        pending_books_ = uuids.size();
+        if (on_progress_) on_progress_();
+        for (const auto& uuid : uuids) {
+            if (stop_) return;
+            IndexBook(uuid);
+            pending_books_--;
+            if (on_progress_) on_progress_();
+        }
+    }
+}
+
+void TextIndexer::IndexBook(const std::string& uuid) {
+    auto book = db_manager_.GetBookByUUID(uuid);
+    if (!book || book->path.empty() || !fs::exists(book->path)) {
+        return; // Left pending; it is picked up again once the file is back
+    }
+
+    int first_chapter = db_manager_.BeginTextIndex(uuid, book->hash);
+    if (first_chapter < 0) return;
+
+    auto parser = CreateParser(book->path, parse_token_);
+    if (stop_) return; // A cut-short parse is partial; leave the book pending
+    if (!parser) {
+        db_manager_.FinishTextIndex(uuid);
+        return;
+    }
+
+    // Chapter numbers must match the reader's: flat pre-order chapters, or pages for a PDF.
+    int chapter_count = 0;
+    if (auto* pdf_parser = dynamic_cast<PdfParser*>(parser.get())) {
+        if (!pdf_parser->Load()) {
+            if (stop_) return;
+            DebugLogger::log("[TextIndexer] Failed to load PDF: " + book->path);
+            db_manager_.FinishTextIndex(uuid);
+            return;
+        }
+        chapter_count = pdf_parser->GetTotalPages();
+        for (int page = first_chapter; page < chapter_count; ++page) {
+            if (stop_) return;
+            if (!db_manager_.AddTextIndexChapter(uuid, page, {pdf_parser->GetTextForPage(page)})) return;
+        }
+    } else {
+        std::vector<BookChapter> flat_chapters;
+        flatten_chapters_for_pagination(parser->GetChapters(), flat_chapters);
+        chapter_count = flat_chapters.size();
+        for (int i = first_chapter; i < chapter_count; ++i) {
+            if (stop_) return;
+            if (!db_manager_.AddTextIndexChapter(uuid, i, flat_chapters[i].paragraphs)) return;
+        }
+    }
+
+    db_manager_.FinishTextIndex(uuid);
+    DebugLogger::log("[TextIndexer] Indexed \"" + book->title + "\" (" + std::to_string(chapter_count) + " chapters).");
+}
@@ -0,0 +1,47 @@
+#ifndef TEXT_INDEXER_H
+#define TEXT_INDEXER_H
+
+#include "CancellationToken.h"
+#include "DatabaseManager.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Feeds the text of every book in the library into the database's full-text table on a
+// background thread, for the library-wide search view. Progress is committed one chapter
+// at a time, so an interrupted book resumes where it stopped, and a book is only re-read
+// when its file hash changes.
+class TextIndexer {
+public:
+    // on_progress is called from the indexer thread whenever the pending count changes.
+    TextIndexer(DatabaseManager& db_manager, std::function<void()> on_progress);
+    ~TextIndexer();
+
+    void Start();
+    // Looks for new or changed books, e.g. after the library was modified.
+    void RequestScan();
+    // Finishes the chapter being written and joins the thread.
+    void Stop();
+
+    // Books still to index in the current pass; 0 when idle.
+    int GetPendingBooks() const { return pending_books_; }
+
+private:
+    void IndexLoop();
+    void IndexBook(const std::string& uuid);
+
+    DatabaseManager& db_manager_;
+    std::function<void()> on_progress_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool scan_requested_ = true;
+    std::atomic<bool> stop_{false};
+    CancellationToken parse_token_; // Lets Stop() cut a long parse short
+    std::atomic<int> pending_books_{0};
+};
+
+#endif // TEXT_INDEXER_H
@@ -6,7 +6,7 @@
 
 namespace fs = std::filesystem;
 
-TxtParser::TxtParser(const std::string& file_path) : file_path_(file_path) {
+TxtParser::TxtParser(const std::string& file_path, const CancellationToken& cancel) : file_path_(file_path) {
     std::ifstream file(file_path);
     if (!file.is_open()) {
         std::cerr << "Failed to open txt file: " << file_path << std::endl;
@@ -21,6 +21,9 @@ TxtParser::TxtParser(const std::string& file_path) : file_path_(file_path) {
     std::stringstream current_paragraph;
 
     while (std::getline(file, line)) {
+        if (cancel.IsCancelled()) {
+            return;
+        }
         if (line.empty()) {
             if (current_paragraph.tellp() > 0) {
                 chapter.paragraphs.push_back(current_paragraph.str());
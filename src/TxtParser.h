@@ -2,13 +2,15 @@
 #ifndef TXT_PARSER_H
 #define TXT_PARSER_H
 
+#include "CancellationToken.h"
 #include "IBookParser.h"
 #include <string>
 #include <vector>
 
 class TxtParser : public IBookParser {
 public:
-    TxtParser(const std::string& file_path);
+    // Parsing stops early, leaving a partial book, if cancel is triggered.
+    TxtParser(const std::string& file_path, const CancellationToken& cancel = CancellationToken());
 
     bool isOpen() const;
     std::string GetTitle() const override;
@@ -1,8 +1,41 @@
 #include "UIComponents.h"
+#include "PerfStats.h"
+#include "ftxui/dom/node.hpp"
+#include "ftxui/screen/screen.hpp"
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <ctime>
 #include <iomanip>
 
+namespace {
+// Records the time from layout to the end of drawing as one Render sample per frame.
+class FrameTimerNode : public Node {
+public:
+    explicit FrameTimerNode(Element child) : Node(Elements{std::move(child)}) {}
+
+    void ComputeRequirement() override {
+        start_ = std::chrono::steady_clock::now();
+        children_[0]->ComputeRequirement();
+        requirement_ = children_[0]->requirement();
+    }
+
+    void SetBox(Box box) override {
+        Node::SetBox(box);
+        children_[0]->SetBox(box);
+    }
+
+    void Render(Screen& screen) override {
+        children_[0]->Render(screen);
+        PerfStats::Record(PerfStage::Render, std::chrono::steady_clock::now() - start_);
+        PerfStats::RecordFrame();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+}
+
 UIComponents::UIComponents(AppState& state, ScreenInteractive& screen) 
     : app_state_(state), screen_(screen) {}
 
@@ -10,7 +43,6 @@ void UIComponents::CreateComponents() {
     // Create menu components
     library_menu_ = Menu(&app_state_.library_visible_books, &app_state_.selected_book_index);
     picker_menu_ = Menu(&app_state_.picker_entries, &app_state_.selected_picker_entry);
-    toc_menu_ = Menu(&app_state_.toc_visible_entries, &app_state_.selected_toc_entry);
     
     // Create button components
     ok_button_ = Button(" OK ", [&]{ 
@@ -43,7 +75,7 @@ void UIComponents::CreateComponents() {
     main_container_ = Container::Tab({
         library_menu_,
         Renderer([]{ return text("Reader placeholder"); }),
-        toc_menu_,
+        Renderer([]{ return text("TOC placeholder"); }),
         picker_menu_,
         ok_button_,
         Renderer([]{ return text("Loading placeholder"); }),
@@ -101,22 +133,24 @@ Element UIComponents::RenderLibraryView() {
         app_state_.last_library_width = screen_.dimx();
         app_state_.last_library_height = screen_.dimy();
         app_state_.library_entries_per_page = app_state_.last_library_height > 8 ? app_state_.last_library_height - 8 : 1;
-        app_state_.library_total_pages = app_state_.books.empty() ? 1 : (app_state_.books.size() + app_state_.library_entries_per_page - 1) / app_state_.library_entries_per_page;
+        int book_count = app_state_.library_model->GetCount();
+        app_state_.library_total_pages = book_count == 0 ? 1 : (book_count + app_state_.library_entries_per_page - 1) / app_state_.library_entries_per_page;
         if (app_state_.library_current_page >= app_state_.library_total_pages) {
             app_state_.library_current_page = std::max(0, app_state_.library_total_pages - 1);
         }
     }
     
-    int start_index = app_state_.library_current_page * app_state_.library_entries_per_page;
-    int end_index = std::min(start_index + app_state_.library_entries_per_page, (int)app_state_.books.size());
-    
-    app_state_.library_visible_books.clear();
-    if (start_index < end_index) {
-        app_state_.library_visible_books.assign(app_state_.book_display_list.begin() + start_index, app_state_.book_display_list.begin() + end_index);
+    // Fetch just the visible window; the menu's rows are only re-copied when it changed.
+    auto& library = *app_state_.library_model;
+    library.SetWindow(app_state_.library_current_page * app_state_.library_entries_per_page, app_state_.library_entries_per_page);
+    const auto& display_rows = library.GetDisplayRows(app_state_.cloud_sync_enabled);
+    if (library.GetGeneration() != app_state_.library_visible_generation) {
+        app_state_.library_visible_books = display_rows;
+        app_state_.library_visible_generation = library.GetGeneration();
     }
 
     // Footer Logic
-    std::string footer_text = "[a] Add | [s] System Info | [q] Quit";
+    std::string footer_text = "[a] Add | [/] Search | [f] Find in books | [o] Sort | [s] System Info | [q] Quit";
     if (app_state_.cloud_sync_enabled) {
         footer_text += " | [c] Cloud Off | [r] Refresh";
     } else {
@@ -124,17 +158,19 @@ Element UIComponents::RenderLibraryView() {
     }
 
     // Context-sensitive part of the footer
-    if (app_state_.cloud_sync_enabled && !app_state_.books.empty()) {
-        int global_index = app_state_.library_current_page * app_state_.library_entries_per_page + app_state_.selected_book_index;
-        if (global_index < app_state_.books.size()) {
-            const auto& book = app_state_.books[global_index];
-            if (book.sync_status == "local") footer_text += " | [u] Upload";
-            if (book.sync_status == "cloud") footer_text += " | [Enter] Download";
-            if (book.sync_status == "local" || book.sync_status == "synced") footer_text += " | [d] Delete";
+    if (app_state_.cloud_sync_enabled && library.GetCount() > 0) {
+        if (const Book* book = library.GetBook(app_state_.SelectedLibraryRow())) {
+            if (book->sync_status == "local") footer_text += " | [u] Upload";
+            if (book->sync_status == "cloud") footer_text += " | [Enter] Download";
+            if (book->sync_status == "local" || book->sync_status == "synced") footer_text += " | [d] Delete";
         }
-    } else if (!app_state_.cloud_sync_enabled && !app_state_.books.empty()) {
+    } else if (!app_state_.cloud_sync_enabled && library.GetCount() > 0) {
         footer_text += " | [d] Delete";
     }
+    if (app_state_.library_search_active) {
+        // Keys type into the search box, so only these work while it is open.
+        footer_text = "[Esc] Clear search | [Enter] Open | ←/→ Page";
+    }
 
     // Sync status message
     Element sync_status_element;
@@ -154,7 +190,7 @@ Element UIComponents::RenderLibraryView() {
     struct tm ltm;
     localtime_r(&now, &ltm);
     char time_buf[32];
-    strftime(time_buf, sizeof(time_buf), "%H:%M:%S", &ltm);
+    strftime(time_buf, sizeof(time_buf), "%H:%M", &ltm); // Redrawn on minute boundaries only
     Element clock_element = text(std::string(time_buf)) | dim;
 
     auto footer = hbox({
@@ -166,7 +202,20 @@ Element UIComponents::RenderLibraryView() {
     });
 
     std::string cloud_icon = app_state_.cloud_sync_enabled ? " ☁️" : " 💻";
-    auto title = hbox({ text("Ebook Library") | bold, text(cloud_icon) }) | hcenter;
+    static const char* const kSortLabels[kLibrarySortKeyCount] = {"Recently read", "Title", "Author", "Date added"};
+    auto title = hbox({
+        text("Ebook Library") | bold,
+        text(cloud_icon),
+        text("  Sorted by " + std::string(kSortLabels[static_cast<int>(library.GetSortKey())])) | dim
+    }) | hcenter;
+    if (app_state_.library_search_active) {
+        title = hbox({
+            text("Search: ") | bold,
+            text(app_state_.library_search_input) | inverted,
+            filler(),
+            text(std::to_string(library.GetCount()) + " found") | dim
+        });
+    }
 
     return vbox({
         title,
@@ -186,20 +235,18 @@ Element UIComponents::RenderReaderView() {
     int page_width = is_dual ? (screen_.dimx() / 2) - 4 : screen_.dimx() - 4;
     int page_height = screen_.dimy() - 6;
 
-    if (!app_state_.paginated || page_width != app_state_.last_page_width || page_height != app_state_.last_page_height) {
-        app_state_.book_view_model->Paginate(page_width, page_height);
-        app_state_.paginated = true;
-        app_state_.last_page_width = page_width;
-        app_state_.last_page_height = page_height;
+    // Layout requests and adoption happen at frame start; see EventHandlers::SyncReaderLayout().
+    if (app_state_.scroll_mode_enabled) {
+        return RenderScrollView();
+    }
+    if (app_state_.book_view_model->GetTotalPages() == 0 && app_state_.book_view_model->IsLayoutPending()) {
+        return RenderOpeningPage(page_width, page_height);
     }
     
-    std::string progress_str = "Page: " + std::to_string(app_state_.current_page + 1) + " / " + std::to_string(app_state_.book_view_model->GetTotalPages());
+    std::string progress_str = "Page: " + std::to_string(app_state_.current_page + 1) + " / " + std::to_string(app_state_.book_view_model->GetTotalPages())
+                             + " (" + std::to_string(static_cast<int>(app_state_.book_view_model->GetFractionForPosition(app_state_.current_position) * 100)) + "%)";
     
-    std::string book_title;
-    int global_index = (app_state_.library_current_page * app_state_.library_entries_per_page) + app_state_.selected_book_index;
-    if (global_index < app_state_.books.size()) {
-        book_title = app_state_.books[global_index].title;
-    }
+    std::string book_title = app_state_.current_book.title;
 
     std::string chapter_title = app_state_.book_view_model->GetPageTitleForPage(app_state_.current_page);
     std::string full_title = book_title + " - " + chapter_title;
@@ -207,19 +254,22 @@ Element UIComponents::RenderReaderView() {
     // Page Content
     Element page_content;
     if (is_dual) {
-        auto left_page = vbox(app_state_.book_view_model->GetPageContent(app_state_.current_page, page_width)) | vscroll_indicator | frame | flex;
+        auto left_page = app_state_.book_view_model->GetPageElement(app_state_.current_page, page_width) | vscroll_indicator | frame | flex;
         Element right_page;
         if (app_state_.current_page + 1 < app_state_.book_view_model->GetTotalPages()) {
-            right_page = vbox(app_state_.book_view_model->GetPageContent(app_state_.current_page + 1, page_width)) | vscroll_indicator | frame | flex;
+            right_page = app_state_.book_view_model->GetPageElement(app_state_.current_page + 1, page_width) | vscroll_indicator | frame | flex;
         } else {
             right_page = text("") | frame | flex; // Empty placeholder for the last page
         }
         page_content = hbox({left_page, separator(), right_page});
     } else {
-        page_content = vbox(app_state_.book_view_model->GetPageContent(app_state_.current_page, page_width)) | vscroll_indicator | frame;
+        page_content = app_state_.book_view_model->GetPageElement(app_state_.current_page, page_width) | vscroll_indicator | frame;
     }
 
-    auto status_bar = hbox({text(progress_str), filler(), text("←/k Prev | →/j Next | [d]Mode | [q]Back | [m]TOC")});
+    if (app_state_.book_view_model->IsLayoutPending()) {
+        progress_str += " (re-flowing...)";
+    }
+    auto status_bar = RenderReaderStatusBar(progress_str, "←/k Prev | →/j Next | [d]Mode | [s]Scroll | [g]Go to | [/]Search | [q]Back | [m]TOC");
     
     return vbox({
         text(full_title) | bold | hcenter,
@@ -230,6 +280,76 @@ Element UIComponents::RenderReaderView() {
     }) | border;
 }
 
+Element UIComponents::RenderOpeningPage(int page_width, int page_height) {
+    auto& model = *app_state_.book_view_model;
+
+    // Only the chapter holding the reading position is wrapped; the page count climbs as the
+    // full layout streams in behind it.
+    LineCursor top = model.GetLineForPosition(app_state_.current_position, page_width);
+    Elements lines = model.GetLines(top, std::max(1, page_height), page_width);
+
+    std::string full_title = app_state_.current_book.title + " - " + model.GetChapterTitle(top.chapter_index);
+    std::string progress_str = "Page: - / " + std::to_string(model.GetLayoutProgressPages()) + "+"
+                             + " (" + std::to_string(static_cast<int>(model.GetFractionForPosition(app_state_.current_position) * 100)) + "%)"
+                             + " (laying out " + std::to_string(model.GetLayoutProgressPercent()) + "%)";
+    auto status_bar = RenderReaderStatusBar(progress_str, "←/k Prev | →/j Next | [s]Scroll | [g]Go to | [/]Search | [q]Back | [m]TOC");
+
+    return vbox({
+        text(full_title) | bold | hcenter,
+        separator(),
+        vbox(std::move(lines)) | flex,
+        separator(),
+        status_bar
+    }) | border;
+}
+
+Element UIComponents::RenderReaderStatusBar(const std::string& progress_str, const std::string& key_hints) {
+    if (app_state_.goto_prompt_active) {
+        return hbox({text("Go to page or N%: "), text(app_state_.goto_input) | inverted, filler(), text("[Enter] Go | [Esc] Cancel")});
+    }
+    if (app_state_.search_prompt_active) {
+        return hbox({text("Search: "), text(app_state_.search_input) | inverted, filler(), text("[Enter] Find | [Esc] Cancel")});
+    }
+
+    std::string search_str;
+    if (!app_state_.search_query.empty() && app_state_.book_view_model) {
+        // Hits keep streaming in while the index is still being built; see OpenBook.
+        int progress = app_state_.book_view_model->GetSearchIndexProgress();
+        search_str = " | \"" + app_state_.search_query + "\" " +
+                     (app_state_.search_hit_index >= 0 ? std::to_string(app_state_.search_hit_index + 1) : "-") + "/" +
+                     std::to_string(app_state_.search_hits.size());
+        if (progress < 100) {
+            search_str += " (indexing " + std::to_string(progress) + "%)";
+        }
+    }
+    return hbox({text(progress_str + search_str), filler(), text(key_hints)});
+}
+
+Element UIComponents::RenderScrollView() {
+    auto& model = *app_state_.book_view_model;
+    int line_width = screen_.dimx() - 4;
+    int line_height = std::max(1, screen_.dimy() - 6);
+
+    // Only the lines inside the viewport are materialized.
+    LineCursor top = model.GetLineForPosition(app_state_.current_position, line_width);
+    Elements lines = model.GetLines(top, line_height, line_width);
+
+    std::string book_title = app_state_.current_book.title;
+    std::string full_title = book_title + " - " + model.GetChapterTitle(top.chapter_index);
+
+    std::string progress_str = "Chapter: " + std::to_string(top.chapter_index + 1) + " / " + std::to_string(model.GetChapterCount())
+                             + " (" + std::to_string(static_cast<int>(model.GetFractionForPosition(app_state_.current_position) * 100)) + "%)";
+    auto status_bar = RenderReaderStatusBar(progress_str, "↑/k ↓/j Line | ←/→ Screen | [s]Pages | [g]Go to | [/]Search | [q]Back | [m]TOC");
+
+    return vbox({
+        text(full_title) | bold | hcenter,
+        separator(),
+        vbox(std::move(lines)) | flex,
+        separator(),
+        status_bar
+    }) | border;
+}
+
 Element UIComponents::RenderFilePickerView() {
     return vbox({
         text("Select a Book") | bold | hcenter,
@@ -237,7 +357,7 @@ Element UIComponents::RenderFilePickerView() {
         separator(),
         picker_menu_->Render() | vscroll_indicator | frame | flex,
         separator(),
-        text("[Enter] Select | [Esc] Cancel") | hcenter
+        text("[Enter] Select | [i] Import folder | [Esc] Cancel") | hcenter
     }) | border;
 }
 
@@ -259,28 +379,50 @@ Element UIComponents::RenderLoadingView() {
 }
 
 Element UIComponents::RenderTableOfContentsView() {
-    std::string page_str = "Page " + std::to_string(app_state_.toc_current_page + 1) + "/" + std::to_string(app_state_.toc_total_pages);
+    if (!app_state_.book_view_model) {
+        return text("No book loaded.") | center;
+    }
+    const auto& toc = app_state_.book_view_model->GetTocEntries();
+
+    // Only the rows on screen are built, so huge TOCs cost the same as small ones.
+    int rows = std::max(1, screen_.dimy() - 6);
+    app_state_.toc_visible_rows = rows;
+    int& top = app_state_.toc_scroll_top;
+    int selected = app_state_.selected_toc_entry;
+    if (selected < top) top = selected;
+    if (selected >= top + rows) top = selected - rows + 1;
+    top = std::clamp(top, 0, std::max(0, (int)toc.size() - rows));
+
+    Elements items;
+    int end = std::min((int)toc.size(), top + rows);
+    for (int i = top; i < end; ++i) {
+        auto item = text(std::string(toc[i].depth * 2, ' ') + toc[i].title);
+        items.push_back(i == selected ? item | inverted : item);
+    }
+    if (toc.empty()) {
+        items.push_back(text("This book has no table of contents.") | dim | hcenter);
+    }
+
+    std::string position_str = toc.empty() ? "0/0" : std::to_string(selected + 1) + "/" + std::to_string(toc.size());
     return vbox({
         text("Table of Contents") | bold | hcenter,
         separator(),
-        toc_menu_->Render() | vscroll_indicator | frame | flex,
+        vbox(items) | flex,
         separator(),
         hbox({
             text("[Enter] Go | [Esc] Back"),
             filler(),
-            text(page_str),
+            text(position_str),
             filler(),
-            text("← Prev | Next →")
+            text("↑/↓ Move | ←/→ Page")
         })
     }) | border;
 }
 
 Element UIComponents::RenderConfirmOcrView() {
     std::string book_title_to_ocr;
-    auto it = std::find_if(app_state_.books.begin(), app_state_.books.end(), 
-                          [&](const Book& b){ return b.uuid == app_state_.book_to_action_uuid; });
-    if (it != app_state_.books.end()) {
-        book_title_to_ocr = it->title;
+    if (app_state_.current_book.uuid == app_state_.book_to_action_uuid) {
+        book_title_to_ocr = app_state_.current_book.title;
     }
     
     return vbox({
@@ -322,3 +464,99 @@ Element UIComponents::RenderSystemInfoView() {
 
     return window(text(" System Info "), content) | center;
 }
+
+Element UIComponents::RenderGlobalSearchView() {
+    const auto& hits = app_state_.global_search_hits;
+    Elements rows;
+    for (int i = 0; i < static_cast<int>(hits.size()); ++i) {
+        const auto& hit = hits[i];
+        auto row = vbox({
+            hbox({
+                text(hit.title) | bold,
+                filler(),
+                text("Ch. " + std::to_string(hit.position.chapter_index + 1)) | dim
+            }),
+            paragraph(hit.snippet) | dim
+        });
+        if (i == app_state_.selected_global_search_hit) {
+            row = row | inverted | focus;
+        }
+        rows.push_back(row);
+    }
+    if (rows.empty()) {
+        std::string hint = app_state_.global_search_input.empty() ? "Type to search the text of every book (3+ characters)." : "No matches.";
+        rows.push_back(text(hint) | dim | hcenter);
+    }
+
+    Element status = text(std::to_string(hits.size()) + " found") | dim;
+    int pending = app_state_.text_indexer ? app_state_.text_indexer->GetPendingBooks() : 0;
+    if (pending > 0) {
+        status = text("(indexing, " + std::to_string(pending) + " books left) " + std::to_string(hits.size()) + " found") | dim;
+    }
+
+    return vbox({
+        hbox({
+            text("Find in books: ") | bold,
+            text(app_state_.global_search_input) | inverted,
+            filler(),
+            status
+        }),
+        separator(),
+        vbox(rows) | vscroll_indicator | frame | flex,
+        separator(),
+        text("[Enter] Open at passage | ↑/↓ Select | [Esc] Back")
+    }) | border;
+}
+
+Element UIComponents::RenderImportView() {
+    if (!app_state_.importer) {
+        return text("No import running.") | center;
+    }
+    auto progress = app_state_.importer->GetProgress();
+
+    std::string status;
+    if (progress.finished) {
+        status = progress.cancelled ? "Import cancelled." : "Import complete.";
+    } else if (progress.scanning) {
+        status = "Scanning... " + std::to_string(progress.found) + " books found";
+    } else {
+        status = "Importing " + std::to_string(progress.processed) + " of " + std::to_string(progress.found);
+    }
+    float ratio = progress.found > 0 ? static_cast<float>(progress.processed) / progress.found : 0.0f;
+
+    return vbox({
+        text("Import Folder") | bold | hcenter,
+        text(app_state_.importer->GetFolder().string()) | color(Color::Yellow),
+        separator(),
+        text(status),
+        gauge(progress.finished ? 1.0f : ratio),
+        text("Added: " + std::to_string(progress.added) +
+             " | Duplicates: " + std::to_string(progress.duplicates) +
+             " | Failed: " + std::to_string(progress.failed)),
+        text(progress.current_file) | dim,
+        separator(),
+        text(progress.finished ? "[Enter] Done" : "[Esc] Cancel") | hcenter
+    }) | border | size(WIDTH, GREATER_THAN, 50) | center;
+}
+
+Element UIComponents::TimeFrame(Element document) {
+    return std::make_shared<FrameTimerNode>(std::move(document));
+}
+
+Element UIComponents::RenderPerfOverlay() {
+    char buf[96];
+    Elements rows;
+    rows.push_back(text("Stage          p50    p95    p99    max ms") | bold);
+    for (const auto& summary : PerfStats::GetSummaries()) {
+        if (summary.samples == 0) {
+            std::snprintf(buf, sizeof(buf), "%-12s      -      -      -      -", summary.stage.c_str());
+        } else {
+            std::snprintf(buf, sizeof(buf), "%-12s %6.1f %6.1f %6.1f %6.1f", summary.stage.c_str(),
+                          summary.p50_ms, summary.p95_ms, summary.p99_ms, summary.max_ms);
+        }
+        rows.push_back(text(buf));
+    }
+    rows.push_back(separator());
+    rows.push_back(text("Redraws/s: " + std::to_string(PerfStats::GetFramesPerSecond())));
+    return window(text(" Perf [P] "), vbox(rows)) | clear_under;
+}
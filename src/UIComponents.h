@@ -25,6 +25,10 @@ public:
     // Render different views
     Element RenderLibraryView();
     Element RenderReaderView();
+    Element RenderScrollView();
+    // Shown while a book is still being laid out for the first time
+    Element RenderOpeningPage(int page_width, int page_height);
+    Element RenderReaderStatusBar(const std::string& progress_str, const std::string& key_hints);
     Element RenderFilePickerView();
     Element RenderShowMessageView();
     Element RenderLoadingView();
@@ -32,6 +36,11 @@ public:
     Element RenderConfirmOcrView();
     Element RenderDeleteConfirmView();
     Element RenderSystemInfoView();
+    Element RenderGlobalSearchView();
+    Element RenderImportView();
+    Element RenderPerfOverlay();
+    // Wraps a frame's document so FTXUI's layout and drawing of it are timed.
+    Element TimeFrame(Element document);
     
 private:
     AppState& app_state_;
@@ -40,7 +49,6 @@ private:
     // UI Components
     Component library_menu_;
     Component picker_menu_;
-    Component toc_menu_;
     Component ok_button_;
     Component confirm_ocr_container_;
     Component delete_menu_;
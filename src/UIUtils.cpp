@@ -57,28 +57,20 @@ bool promptForGoogleCredentials(ConfigManager& configManager) {
 namespace fs = std::filesystem;
 
 // --- Parser Factory ---
-std::unique_ptr<IBookParser> CreateParser(const std::string& path) {
+std::unique_ptr<IBookParser> CreateParser(const std::string& path, const CancellationToken& cancel) {
 
     std::string extension = fs::path(path).extension().string();
     std::transform(extension.begin(), extension.end(), extension.begin(),
                    [](unsigned char c){ return std::tolower(c); });
 
-    if (extension == ".epub") return std::make_unique<EpubParser>(path);
-    if (extension == ".txt") return std::make_unique<TxtParser>(path);
-    if (extension == ".mobi" || extension == ".azw3") return std::make_unique<MobiParser>(path);
-    if (extension == ".pdf") return std::make_unique<PdfParser>(path);
+    if (extension == ".epub") return std::make_unique<EpubParser>(path, cancel);
+    if (extension == ".txt") return std::make_unique<TxtParser>(path, cancel);
+    if (extension == ".mobi" || extension == ".azw3") return std::make_unique<MobiParser>(path, cancel);
+    if (extension == ".pdf") return std::make_unique<PdfParser>(path, cancel);
     return nullptr;
 }
 
 // --- Helper Functions ---
-void FlattenChapters(const std::vector<BookChapter>& chapters, std::vector<std::string>& entries, int depth) {
-    for (const auto& chapter : chapters) {
-        std::string prefix = std::string(depth * 2, ' ');
-        entries.push_back(prefix + chapter.title);
-        FlattenChapters(chapter.children, entries, depth + 1);
-    }
-}
-
 void SortEntries(std::vector<std::string>& entries, const fs::path& p) {
     std::sort(entries.begin(), entries.end(),
               [&](const std::string& a, const std::string& b) {
@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 
+#include "CancellationToken.h"
 #include "IBookParser.h"
 #include "ConfigManager.h"
 
@@ -15,10 +16,10 @@ bool promptForGoogleCredentials(ConfigManager& configManager);
 namespace fs = std::filesystem;
 
 // --- Parser Factory ---
-std::unique_ptr<IBookParser> CreateParser(const std::string& path);
+// The parser checks cancel while it parses and stops early once it is triggered.
+std::unique_ptr<IBookParser> CreateParser(const std::string& path, const CancellationToken& cancel = CancellationToken());
 
 // --- Helper Functions ---
-void FlattenChapters(const std::vector<BookChapter>& chapters, std::vector<std::string>& entries, int depth = 0);
 void SortEntries(std::vector<std::string>& entries, const fs::path& p);
 void UpdatePickerEntries(const fs::path& p, std::vector<std::string>& entries, int& selected_entry);
 